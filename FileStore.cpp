@@ -7,218 +7,664 @@
  */
 
 #include "FileStore.h"
+#include <QDir>
+#include <QFile>
+#include <QTimer>
 #include <QtEndian>
+#include <QVarLengthArray>
 #include <QDebug>
+#include <cstring>
+#include <new>
+
+#ifdef Q_OS_WIN
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+namespace {
+// 文件记录子请求头：参考类型(1) + 文件号(2) + 记录号(2) + 记录长度(2)
+constexpr int FILE_SUB_REQUEST_HEADER = 7;
+
+// 磁盘文件头，之后紧跟 RecordPageArray 的页存储
+struct FileStorageHeader
+{
+    char magic[4];
+    quint16 version;
+    quint16 fileNumber;
+    quint16 totalRecords;
+    quint16 descriptionSize;
+    char description[116];  // UTF-8，超长截断
+};
+static_assert(sizeof(FileStorageHeader) == 128, "文件头长度必须固定且保持 8 字节对齐");
+
+constexpr char STORAGE_MAGIC[4] = { 'M', 'B', 'F', 'R' };
+constexpr quint16 STORAGE_VERSION = 1;
+
+// 把映射区间同步到磁盘
+void flushMappedRange(uchar *address, qsizetype size)
+{
+#ifdef Q_OS_WIN
+    ::FlushViewOfFile(address, SIZE_T(size));
+#else
+    // msync 要求起始地址按系统页对齐
+    static const quintptr pageSize = quintptr(::sysconf(_SC_PAGESIZE));
+    quintptr start = quintptr(address) & ~(pageSize - 1);
+    ::msync(reinterpret_cast<void*>(start), size_t(quintptr(address) - start + quintptr(size)), MS_SYNC);
+#endif
+}
+}
 
 // ========== FileRecord 实现 ==========
 
 FileRecord::FileRecord(quint16 fileNumber, quint16 totalRecords)
     : m_fileNumber(fileNumber)
     , m_totalRecords(totalRecords)
+    , m_records(totalRecords)
+    , m_storageFile(nullptr)
+    , m_mapped(nullptr)
+    , m_headerDirty(false)
+{
+}
+
+FileRecord::~FileRecord()
+{
+    if (m_storageFile) {
+        flush();
+        m_storageFile->unmap(m_mapped);
+        delete m_storageFile;
+    }
+}
+
+bool FileRecord::attachStorage(const QString &path)
+{
+    // 打开和映射磁盘文件期间不持记录锁，请求仍可读写内存中的数据
+    QMutexLocker storageLocker(&m_storageMutex);
+    if (m_storageFile) {
+        return true;
+    }
+
+    QFile *file = new QFile(path);
+    const qint64 expectedSize = qint64(sizeof(FileStorageHeader)) + RecordPageArray::storageSize(m_totalRecords);
+    bool isNew = false;
+
+    if (!file->open(QIODevice::ReadWrite)) {
+        qWarning() << "打开文件存储失败:" << path << file->errorString();
+        delete file;
+        return false;
+    }
+
+    if (file->size() == 0) {
+        isNew = true;
+        if (!file->resize(expectedSize)) {
+            qWarning() << "分配文件存储失败:" << path << file->errorString();
+            delete file;
+            return false;
+        }
+    } else if (file->size() != expectedSize) {
+        qWarning() << "文件存储长度不匹配:" << path << file->size() << "期望" << expectedSize;
+        delete file;
+        return false;
+    }
+
+    uchar *mapped = file->map(0, expectedSize);
+    if (!mapped) {
+        qWarning() << "映射文件存储失败:" << path << file->errorString();
+        delete file;
+        return false;
+    }
+
+    FileStorageHeader *header = reinterpret_cast<FileStorageHeader*>(mapped);
+    if (isNew) {
+        QByteArray desc = m_description.toUtf8().left(int(sizeof(header->description)));
+        std::memcpy(header->magic, STORAGE_MAGIC, sizeof(STORAGE_MAGIC));
+        header->version = STORAGE_VERSION;
+        header->fileNumber = m_fileNumber;
+        header->totalRecords = m_totalRecords;
+        header->descriptionSize = quint16(desc.size());
+        std::memcpy(header->description, desc.constData(), size_t(desc.size()));
+    } else if (std::memcmp(header->magic, STORAGE_MAGIC, sizeof(STORAGE_MAGIC)) != 0
+               || header->version != STORAGE_VERSION
+               || header->fileNumber != m_fileNumber
+               || header->totalRecords != m_totalRecords) {
+        qWarning() << "文件存储头不匹配:" << path;
+        file->unmap(mapped);
+        delete file;
+        return false;
+    }
+
+    // 页直接指向映射区，未访问的页不占内存，加载时无需读取数据；
+    // 新文件头和数据页一样由后台刷盘同步
+    QWriteLocker locker(&m_lock);
+    m_records.attach(reinterpret_cast<char*>(mapped + sizeof(FileStorageHeader)));
+    m_storageFile = file;
+    m_mapped = mapped;
+    m_headerDirty = isNew;
+    return true;
+}
+
+bool FileRecord::readStorageHeader(const QString &path, quint16 *fileNumber,
+                                   quint16 *totalRecords, QString *description)
 {
+    QFile file(path);
+    FileStorageHeader header;
+    if (!file.open(QIODevice::ReadOnly)
+            || file.read(reinterpret_cast<char*>(&header), sizeof(header)) != qint64(sizeof(header))
+            || std::memcmp(header.magic, STORAGE_MAGIC, sizeof(STORAGE_MAGIC)) != 0
+            || header.version != STORAGE_VERSION) {
+        return false;
+    }
+
+    *fileNumber = header.fileNumber;
+    *totalRecords = header.totalRecords;
+    *description = QString::fromUtf8(header.description,
+                                     qMin<int>(header.descriptionSize, sizeof(header.description)));
+    return true;
 }
 
-QByteArray FileRecord::readRecords(quint16 startRecord, quint16 length) const
+void FileRecord::flush()
+{
+    // 只在取脏页列表时持锁，同步磁盘期间请求仍可读写映射区
+    uchar *mapped = nullptr;
+    bool headerDirty = false;
+    QVector<int> pages;
+    {
+        QWriteLocker locker(&m_lock);
+        if (!m_mapped) {
+            return;
+        }
+        mapped = m_mapped;
+        headerDirty = m_headerDirty;
+        m_headerDirty = false;
+        pages = m_records.takeDirtyPages();
+    }
+
+    if (headerDirty) {
+        flushMappedRange(mapped, sizeof(FileStorageHeader));
+    }
+
+    // 相邻脏页合并为一次同步
+    uchar *base = mapped + sizeof(FileStorageHeader);
+    for (int i = 0; i < pages.size();) {
+        int first = pages.at(i);
+        int last = first;
+        while (++i < pages.size() && pages.at(i) == last + 1) {
+            last++;
+        }
+        qsizetype offset = RecordPageArray::pageStorageOffset(first);
+        flushMappedRange(base + offset, RecordPageArray::pageStorageOffset(last + 1) - offset);
+    }
+}
+
+bool FileRecord::readRecords(quint16 startRecord, quint16 length, char *out) const
 {
     QReadLocker locker(&m_lock);
 
     if (startRecord + length > m_totalRecords) {
-        return QByteArray();
+        return false;
     }
 
-    QByteArray data;
-    for (quint16 i = 0; i < length; ++i) {
-        quint16 recordNum = startRecord + i;
-        QByteArray recordData = m_records.value(recordNum, QByteArray(2, 0));
-        data.append(recordData);
+    return m_records.read(startRecord, length, out);
+}
+
+bool FileRecord::writeRecords(quint16 startRecord, const char *data, int length)
+{
+    QWriteLocker locker(&m_lock);
+
+    if (startRecord + length > m_totalRecords) {
+        return false;
     }
 
-    return data;
+    return m_records.write(startRecord, data, length);
 }
 
-bool FileRecord::writeRecords(quint16 startRecord, const QByteArray &data)
+void FileRecord::setCompression(bool enabled, int cachePages)
 {
     QWriteLocker locker(&m_lock);
+    m_records.setCompression(enabled, cachePages);
+}
 
-    int recordLength = data.size() / 2;
-    if (startRecord + recordLength > m_totalRecords) {
-        return false;
+qsizetype FileRecord::memoryUsage() const
+{
+    QReadLocker locker(&m_lock);
+    return m_records.memoryUsage();
+}
+
+int FileRecord::writtenRecordCount() const
+{
+    QReadLocker locker(&m_lock);
+    return m_records.writtenCount();
+}
+
+QMap<quint16, QByteArray> FileRecord::getWrittenRecords(int maxRecords) const
+{
+    QReadLocker locker(&m_lock);
+    QMap<quint16, QByteArray> result;
+
+    const QVector<int> indexes = m_records.writtenIndexes(0, maxRecords);
+    for (int index : indexes) {
+        QByteArray data(2, Qt::Uninitialized);
+        m_records.read(index, 1, data.data());
+        result.insert(quint16(index), data);
     }
 
-    for (int i = 0; i < recordLength; ++i) {
-        quint16 recordNum = startRecord + i;
-        QByteArray recordData = data.mid(i * 2, 2);
-        m_records[recordNum] = recordData;
+    return result;
+}
+
+int FileRecord::readWrittenPage(int cursor, int maxRecords, QVector<int> *recordNumbers, QByteArray *data) const
+{
+    QReadLocker locker(&m_lock);
+
+    // 多取一条用于确定下一页的起点，锁只覆盖一页的数据量
+    QVector<int> indexes = m_records.writtenIndexes(cursor, maxRecords + 1);
+    int nextCursor = -1;
+    if (indexes.size() > maxRecords) {
+        nextCursor = indexes.takeLast();
     }
 
-    return true;
+    data->resize(indexes.size() * 2);
+    char *out = data->data();
+    for (int index : std::as_const(indexes)) {
+        m_records.read(index, 1, out);
+        out += 2;
+    }
+    *recordNumbers = std::move(indexes);
+    return nextCursor;
 }
 
 // ========== FileStore 实现 ==========
 
 FileStore::FileStore(QObject *parent)
     : QObject(parent)
+    , m_fileCount(0)
+    , m_compression(false)
+    , m_compressionCachePages(RecordPageArray::DEFAULT_CACHE_PAGES)
+    , m_flushTimer(new QTimer(this))
 {
+    for (std::atomic<FileShard*> &shard : m_shards) {
+        shard.store(nullptr, std::memory_order_relaxed);
+    }
+    m_flushPool.setMaxThreadCount(1);
+    m_flushTimer->setInterval(ModbusConst::FILE_FLUSH_INTERVAL_MS);
+    connect(m_flushTimer, &QTimer::timeout, this, &FileStore::scheduleFlush);
 }
 
 FileStore::~FileStore()
 {
-    QWriteLocker locker(&m_lock);
-    qDeleteAll(m_files);
-    m_files.clear();
+    m_flushTimer->stop();
+    m_flushPool.waitForDone();
+
+    // FileRecord 析构时会同步剩余的脏页
+    QMutexLocker locker(&m_createMutex);
+    for (FileSlab *slab : std::as_const(m_slabs)) {
+        for (int i = 0; i < slab->used; ++i) {
+            reinterpret_cast<FileRecord*>(slab->storage[i])->~FileRecord();
+        }
+        delete slab;
+    }
+    m_slabs.clear();
+    for (std::atomic<FileShard*> &shard : m_shards) {
+        delete shard.exchange(nullptr);
+    }
 }
 
-bool FileStore::createFile(quint16 fileNumber, const QString &description, quint16 totalRecords)
+bool FileStore::setStorageDirectory(const QString &path)
 {
-    QWriteLocker locker(&m_lock);
-
-    if (m_files.contains(fileNumber)) {
+    QDir dir(path);
+    if (!dir.mkpath(QStringLiteral("."))) {
+        qWarning() << "无法创建文件存储目录:" << path;
         return false;
     }
 
-    FileRecord *file = new FileRecord(fileNumber, totalRecords);
+    QMutexLocker locker(&m_createMutex);
+    m_storageDir = dir.absolutePath();
+
+    // 加载已有文件：只读文件头并建立映射，数据按需由系统换入
+    const QStringList entries = dir.entryList({ QStringLiteral("file_*.mbf") }, QDir::Files, QDir::Name);
+    for (const QString &entry : entries) {
+        const QString filePath = m_storageDir + QLatin1Char('/') + entry;
+        quint16 fileNumber = 0;
+        quint16 totalRecords = 0;
+        QString description;
+        if (!FileRecord::readStorageHeader(filePath, &fileNumber, &totalRecords, &description)
+                || filePath != storagePath(fileNumber)) {
+            qWarning() << "跳过无效的文件存储:" << filePath;
+            continue;
+        }
+        if (findFile(fileNumber)) {
+            continue;  // 内存中已有同号文件，下面统一挂接
+        }
+
+        // newFile 在设置了存储目录时直接挂接该磁盘文件
+        newFile(fileNumber, description, totalRecords);
+    }
+
+    // 之前只在内存中的文件也落盘：与同号磁盘文件合并，内存中写过的记录优先；
+    // 磁盘文件头不一致时该文件仍只保存在内存中
+    const QVector<FileRecord*> files = allFiles();
+    for (FileRecord *file : files) {
+        file->attachStorage(storagePath(file->fileNumber()));
+    }
+    locker.unlock();
+
+    m_flushTimer->start();
+    qDebug() << "文件存储目录:" << m_storageDir << "已加载文件数:" << files.size();
+    return true;
+}
+
+void FileStore::flushAll()
+{
+    const QVector<FileRecord*> files = allFiles();
+    for (FileRecord *file : files) {
+        file->flush();
+    }
+}
+
+void FileStore::setCompression(bool enabled, int cachePages)
+{
+    QMutexLocker locker(&m_createMutex);
+    m_compression = enabled;
+    m_compressionCachePages = cachePages;
+
+    const QVector<FileRecord*> files = allFiles();
+    for (FileRecord *file : files) {
+        file->setCompression(enabled, cachePages);
+    }
+}
+
+qsizetype FileStore::memoryUsage() const
+{
+    qsizetype bytes = 0;
+    const QVector<FileRecord*> files = allFiles();
+    for (const FileRecord *file : files) {
+        bytes += file->memoryUsage();
+    }
+    return bytes;
+}
+
+// 定时把脏页交给后台线程同步，上一轮未完成时跳过本轮
+void FileStore::scheduleFlush()
+{
+    m_flushPool.tryStart([this]() { flushAll(); });
+}
+
+QString FileStore::storagePath(quint16 fileNumber) const
+{
+    return QString("%1/file_%2.mbf").arg(m_storageDir).arg(fileNumber, 5, 10, QChar('0'));
+}
+
+FileRecord *FileStore::findFile(quint16 fileNumber) const
+{
+    FileShard *shard = m_shards[fileNumber >> 8].load(std::memory_order_acquire);
+    return shard ? shard->slots[fileNumber & 0xFF].load(std::memory_order_acquire) : nullptr;
+}
+
+int FileStore::fileRecordCount(quint16 fileNumber) const
+{
+    FileRecord *file = findFile(fileNumber);
+    return file ? file->totalRecords() : -1;
+}
+
+// 调用者持有 m_createMutex，且该文件号尚不存在；
+// deferStorage 为 true 时先发布内存中的文件，磁盘文件的创建和映射交给后台线程
+FileRecord *FileStore::newFile(quint16 fileNumber, const QString &description, quint16 totalRecords,
+                               bool deferStorage)
+{
+    if (m_slabs.isEmpty() || m_slabs.last()->used == FILE_SLAB_SIZE) {
+        m_slabs.append(new FileSlab);
+    }
+    FileSlab *slab = m_slabs.last();
+    FileRecord *file = new (slab->storage[slab->used++]) FileRecord(fileNumber, totalRecords);
+
     file->setDescription(description);
-    m_files[fileNumber] = file;
+    if (!m_storageDir.isEmpty() && !deferStorage && !file->attachStorage(storagePath(fileNumber))) {
+        qWarning() << "文件" << fileNumber << "无法落盘，仅保存在内存中";
+    }
+    if (m_compression) {
+        file->setCompression(true, m_compressionCachePages);
+    }
+
+    // 对象完全初始化后再发布，无锁读者看到指针时即可安全使用
+    std::atomic<FileShard*> &shardSlot = m_shards[fileNumber >> 8];
+    FileShard *shard = shardSlot.load(std::memory_order_relaxed);
+    if (!shard) {
+        shard = new FileShard();
+        shardSlot.store(shard, std::memory_order_release);
+    }
+    shard->slots[fileNumber & 0xFF].store(file, std::memory_order_release);
+    m_fileCount.fetch_add(1, std::memory_order_relaxed);
 
+    // 挂接时已写入的记录会合并到磁盘文件中
+    if (!m_storageDir.isEmpty() && deferStorage) {
+        const QString path = storagePath(fileNumber);
+        m_flushPool.start([file, path, fileNumber]() {
+            if (!file->attachStorage(path)) {
+                qWarning() << "文件" << fileNumber << "无法落盘，仅保存在内存中";
+            }
+        });
+    }
+    return file;
+}
+
+// 按文件号顺序返回所有文件
+QVector<FileRecord*> FileStore::allFiles() const
+{
+    QVector<FileRecord*> files;
+    files.reserve(m_fileCount.load(std::memory_order_relaxed));
+    for (const std::atomic<FileShard*> &shardSlot : m_shards) {
+        FileShard *shard = shardSlot.load(std::memory_order_acquire);
+        if (!shard) {
+            continue;
+        }
+        for (const std::atomic<FileRecord*> &slot : shard->slots) {
+            if (FileRecord *file = slot.load(std::memory_order_acquire)) {
+                files.append(file);
+            }
+        }
+    }
+    return files;
+}
+
+bool FileStore::createFile(quint16 fileNumber, const QString &description, quint16 totalRecords)
+{
+    QMutexLocker locker(&m_createMutex);
+
+    if (findFile(fileNumber)) {
+        return false;
+    }
+
+    newFile(fileNumber, description, totalRecords);
     return true;
 }
 
 QByteArray FileStore::handleReadFileRecord(const QByteArray &request)
 {
-    // 验证最小长度（功能码 + 字节计数 + 参考类型 + 文件号 + 记录号 + 记录长度）
-    if (request.size() < 8) {
+    // 请求格式：功能码(1) + ByteCount(1) + N 个子请求
+    // 子请求：参考类型(1) + 文件号(2) + 记录号(2) + 记录长度(2)，共7字节
+    if (request.size() < 2) {
         return buildErrorResponse(0x94, IllegalDataValue);
     }
 
-    // 解析请求参数
-    quint8 refType = static_cast<quint8>(request[2]);
-    
-    // 验证参考类型必须为6（Modbus标准）
-    if (refType != 6) {
+    const int byteCount = static_cast<quint8>(request[1]);
+    if (byteCount < FILE_SUB_REQUEST_HEADER || byteCount > 0xF5
+            || byteCount % FILE_SUB_REQUEST_HEADER != 0 || request.size() < 2 + byteCount) {
         return buildErrorResponse(0x94, IllegalDataValue);
     }
 
-    quint16 fileNumber = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 3));
-    quint16 recordNumber = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 5));
-    quint16 recordLength = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 7));
+    // 先校验全部子请求并计算响应长度，任何一组非法都不返回部分数据
+    struct SubRequest
+    {
+        FileRecord *file;
+        quint16 recordNumber;
+        quint16 recordLength;
+    };
+    QVarLengthArray<SubRequest, 36> groups;
+    int responseSize = 2;  // 功能码(1) + ByteCount(1)
 
-    // Modbus标准限制：最多126个记录（每个记录2字节 = 252字节）
-    // ByteCount字段只有1字节，最大值255 = 1(SubRespLength) + 1(RefType) + 252(数据) + 1(余量)
-    if (recordLength > 126) {
-        return buildErrorResponse(0x94, IllegalDataValue);
-    }
+    for (int pos = 2; pos < 2 + byteCount; pos += FILE_SUB_REQUEST_HEADER) {
+        const uchar *group = reinterpret_cast<const uchar*>(request.constData() + pos);
 
-    // 验证记录号范围
-    if (recordNumber > 9999) {
-        return buildErrorResponse(0x94, IllegalDataAddress);
-    }
+        // 验证参考类型必须为6（Modbus标准）
+        if (group[0] != 6) {
+            return buildErrorResponse(0x94, IllegalDataValue);
+        }
 
-    // 查找文件
-    QReadLocker locker(&m_lock);
-    if (!m_files.contains(fileNumber)) {
-        qDebug() << "错误: 文件不存在，文件号:" << fileNumber;
-        qDebug() << "当前已创建的文件:" << m_files.keys();
-        return buildErrorResponse(0x94, IllegalDataAddress);
+        quint16 fileNumber = qFromBigEndian<quint16>(group + 1);
+        quint16 recordNumber = qFromBigEndian<quint16>(group + 3);
+        quint16 recordLength = qFromBigEndian<quint16>(group + 5);
+
+        // 验证记录号范围（记录号 0~9999，且不能越过文件末尾）
+        if (recordLength == 0 || recordNumber + recordLength > ModbusConst::MAX_FILE_RECORDS) {
+            return buildErrorResponse(0x94, IllegalDataAddress);
+        }
+
+        // 子响应：子响应长度(1) + 参考类型(1) + 数据(2N)，整个响应不能超过 PDU 上限
+        responseSize += 2 + recordLength * 2;
+        if (responseSize > ModbusConst::MAX_PDU_SIZE) {
+            return buildErrorResponse(0x94, IllegalDataValue);
+        }
+
+        // 查找文件，记录范围不能越过该文件的实际记录数
+        FileRecord *file = findFile(fileNumber);
+        if (!file) {
+            qDebug() << "错误: 文件不存在，文件号:" << fileNumber;
+            return buildErrorResponse(0x94, IllegalDataAddress);
+        }
+        if (recordNumber + recordLength > file->totalRecords()) {
+            return buildErrorResponse(0x94, IllegalDataAddress);
+        }
+
+        groups.append({ file, recordNumber, recordLength });
     }
 
-    FileRecord *file = m_files[fileNumber];
-    locker.unlock();
+    // 一次分配响应，各组记录数据直接从分页存储拷贝到对应位置
+    // 格式：功能码(1) + ByteCount(1) + N 个 [子响应长度(1) + 参考类型(1) + 数据(2N)]
+    QByteArray response(responseSize, Qt::Uninitialized);
+    char *out = response.data();
+    *out++ = static_cast<char>(0x14);                 // 功能码
+    *out++ = static_cast<char>(responseSize - 2);     // ByteCount
 
-    // 读取数据
-    QByteArray recordData = file->readRecords(recordNumber, recordLength);
-    if (recordData.isEmpty()) {
-        qDebug() << "错误: 读取记录失败";
-        return buildErrorResponse(0x94, IllegalDataAddress);
+    for (const SubRequest &group : groups) {
+        const int dataSize = group.recordLength * 2;
+        *out++ = static_cast<char>(1 + dataSize);     // 子响应长度 = 参考类型(1) + 数据
+        *out++ = static_cast<char>(6);                // 参考类型
+        // 范围已校验，失败只可能是压缩页解压失败
+        if (!group.file->readRecords(group.recordNumber, group.recordLength, out)) {
+            qDebug() << "错误: 读取记录失败，文件号:" << group.file->fileNumber();
+            return buildErrorResponse(0x94, SlaveDeviceFailure);
+        }
+        out += dataSize;
     }
 
-    // 构建响应（严格遵守Modbus标准格式）
-    // 格式：功能码(1) + ByteCount(1) + 子响应长度(1) + 参考类型(1) + 数据(N)
-    // ByteCount = 子响应长度字段(1) + 参考类型(1) + 数据(N)
-    // 子响应长度 = 参考类型(1) + 数据(N)
-    
-    quint8 subRespLength = 1 + recordData.size();  // 参考类型(1) + 数据
-    quint8 byteCountValue = 1 + subRespLength;      // 子响应长度字段(1) + 子响应内容
-    
-    qDebug() << "计算响应长度 - 数据:" << recordData.size() << "字节,"
-             << "子响应长度:" << subRespLength << "字节,"
-             << "ByteCount:" << byteCountValue << "字节";
-    
-    // 验证长度不会溢出1字节
-    if (subRespLength > 255 || byteCountValue > 255) {
-        qDebug() << "致命错误: 响应长度超过255字节限制！";
-        return buildErrorResponse(0x94, IllegalDataValue);
+    for (const SubRequest &group : groups) {
+        emit fileRead(group.file->fileNumber(), group.recordNumber, group.recordLength);
     }
-    
-    QByteArray response;
-    response.append(static_cast<char>(0x14));                    // 功能码
-    response.append(static_cast<char>(byteCountValue));          // ByteCount
-    response.append(static_cast<char>(subRespLength));           // 子响应长度
-    response.append(static_cast<char>(6));                       // 参考类型
-    response.append(recordData);                                  // 记录数据
-
-    qDebug() << "成功读取文件记录，响应总长度:" << response.size();
-    qDebug() << "响应格式: FC(1) + ByteCount(" << byteCountValue << ") + SubRespLen(" 
-             << subRespLength << ") + RefType(1) + Data(" << recordData.size() << ")";
-    qDebug() << "响应前32字节 (十六进制):" << response.left(32).toHex(' ').toUpper();
-    if (response.size() > 32) {
-        qDebug() << "响应总长度:" << response.size() << "字节 (仅显示前32字节)";
-    }
-    emit fileRead(fileNumber, recordNumber, recordLength);
     return response;
 }
 
 QByteArray FileStore::handleWriteFileRecord(const QByteArray &request)
 {
-    // 验证最小长度（功能码 + 字节计数 + 参考类型 + 文件号 + 记录号 + 记录长度 + 至少2字节数据）
-    if (request.size() < 10) {
+    // 请求格式：功能码(1) + ByteCount(1) + N 个子请求
+    // 子请求：参考类型(1) + 文件号(2) + 记录号(2) + 记录长度(2) + 数据(2N)
+    if (request.size() < 2) {
         return buildErrorResponse(0x95, IllegalDataValue);
     }
 
-    quint8 refType = static_cast<quint8>(request[2]);
-    
-    // 验证参考类型必须为6（Modbus标准）
-    if (refType != 6) {
+    const int byteCount = static_cast<quint8>(request[1]);
+    if (byteCount < FILE_SUB_REQUEST_HEADER + 2 || byteCount > 0xFB || request.size() < 2 + byteCount) {
         return buildErrorResponse(0x95, IllegalDataValue);
     }
 
-    quint16 fileNumber = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 3));
-    quint16 recordNumber = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 5));
-    quint16 recordLength = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 7));
-    QByteArray recordData = request.mid(9);
+    struct SubRequest
+    {
+        quint16 fileNumber;
+        quint16 recordNumber;
+        quint16 recordLength;
+        int dataOffset;
+    };
+    QVarLengthArray<SubRequest, 28> groups;
+
+    // 先校验全部子请求，任何一组非法都不写入
+    const int end = 2 + byteCount;
+    int pos = 2;
+    while (pos < end) {
+        if (end - pos < FILE_SUB_REQUEST_HEADER) {
+            return buildErrorResponse(0x95, IllegalDataValue);
+        }
 
-    // Modbus标准限制：最多126个记录（与读操作一致）
-    if (recordLength > 126) {
-        return buildErrorResponse(0x95, IllegalDataValue);
-    }
+        const uchar *group = reinterpret_cast<const uchar*>(request.constData() + pos);
 
-    // 验证数据长度（每个记录2字节）
-    if (recordData.size() != recordLength * 2) {
-        return buildErrorResponse(0x95, IllegalDataValue);
+        // 验证参考类型必须为6（Modbus标准）
+        if (group[0] != 6) {
+            return buildErrorResponse(0x95, IllegalDataValue);
+        }
+
+        quint16 fileNumber = qFromBigEndian<quint16>(group + 1);
+        quint16 recordNumber = qFromBigEndian<quint16>(group + 3);
+        quint16 recordLength = qFromBigEndian<quint16>(group + 5);
+
+        // 验证数据长度（每个记录2字节，不能超出 ByteCount 范围）
+        if (recordLength == 0 || end - pos - FILE_SUB_REQUEST_HEADER < recordLength * 2) {
+            return buildErrorResponse(0x95, IllegalDataValue);
+        }
+
+        // 验证记录号范围（记录号 0~9999，且不能越过文件末尾）；
+        // 已存在的文件按其实际记录数校验，不存在的文件写入时按最大记录数创建
+        const int recordCount = fileRecordCount(fileNumber);
+        const int limit = recordCount >= 0 ? recordCount : ModbusConst::MAX_FILE_RECORDS;
+        if (recordNumber + recordLength > limit) {
+            return buildErrorResponse(0x95, IllegalDataAddress);
+        }
+
+        groups.append({ fileNumber, recordNumber, recordLength, pos + FILE_SUB_REQUEST_HEADER });
+        pos += FILE_SUB_REQUEST_HEADER + recordLength * 2;
     }
 
-    // 验证记录号范围
-    if (recordNumber > 9999) {
-        return buildErrorResponse(0x95, IllegalDataAddress);
+    for (const SubRequest &group : groups) {
+        // 写入记录数据（文件不存在时自动创建）
+        if (!writeRecords(group.fileNumber, group.recordNumber,
+                          request.constData() + group.dataOffset, group.recordLength)) {
+            return buildErrorResponse(0x95, SlaveDeviceFailure);
+        }
     }
 
-    // 获取或自动创建文件（最多10000条记录）
-    QWriteLocker locker(&m_lock);
-    if (!m_files.contains(fileNumber)) {
-        m_files[fileNumber] = new FileRecord(fileNumber, 10000);
+    for (const SubRequest &group : groups) {
+        emit fileWritten(group.fileNumber, group.recordNumber, group.recordLength * 2);
     }
 
-    FileRecord *file = m_files[fileNumber];
-    locker.unlock();
+    // 回显请求作为响应（Modbus FC21标准行为）
+    return request.left(end);
+}
 
-    // 写入记录数据
-    if (!file->writeRecords(recordNumber, recordData)) {
-        return buildErrorResponse(0x95, SlaveDeviceFailure);
-    }
+bool FileStore::readRecords(quint16 fileNumber, quint16 startRecord, quint16 length, char *out) const
+{
+    FileRecord *file = findFile(fileNumber);
+    return file && file->readRecords(startRecord, length, out);
+}
 
-    emit fileWritten(fileNumber, recordNumber, recordData.size());
+bool FileStore::writeRecords(quint16 fileNumber, quint16 startRecord, const char *data, quint16 length)
+{
+    return fileForWrite(fileNumber)->writeRecords(startRecord, data, length);
+}
 
-    // 回显请求作为响应（Modbus FC21标准行为）
-    return request;
+// 获取或自动创建文件（最多10000条记录）；文件已存在时不加锁
+FileRecord *FileStore::fileForWrite(quint16 fileNumber)
+{
+    if (FileRecord *file = findFile(fileNumber)) {
+        return file;
+    }
+
+    QMutexLocker locker(&m_createMutex);
+    FileRecord *file = findFile(fileNumber);  // 等锁期间可能已被其他线程创建
+    if (!file) {
+        // 请求路径上不做磁盘操作
+        file = newFile(fileNumber, QString(), ModbusConst::MAX_FILE_RECORDS, true);
+    }
+    return file;
 }
 
 QByteArray FileStore::buildErrorResponse(quint8 errorCode, quint8 exceptionCode) const
@@ -232,10 +678,9 @@ QByteArray FileStore::buildErrorResponse(quint8 errorCode, quint8 exceptionCode)
 // 获取文件列表
 QStringList FileStore::getFileList() const
 {
-    QReadLocker locker(&m_lock);
     QStringList list;
-    for (auto it = m_files.begin(); it != m_files.end(); ++it) {
-        FileRecord *file = it.value();
+    const QVector<FileRecord*> files = allFiles();
+    for (FileRecord *file : files) {
         list.append(QString("文件 %1: %2 (%3 记录)")
                     .arg(file->fileNumber())
                     .arg(file->description())
@@ -247,34 +692,32 @@ QStringList FileStore::getFileList() const
 // 获取文件信息
 QString FileStore::getFileInfo(quint16 fileNumber) const
 {
-    QReadLocker locker(&m_lock);
-    if (!m_files.contains(fileNumber)) {
+    FileRecord *file = findFile(fileNumber);
+    if (!file) {
         return QString("文件 %1 不存在").arg(fileNumber);
     }
     
-    FileRecord *file = m_files[fileNumber];
-    return QString("文件号: %1\n描述: %2\n总记录数: %3\n已写入记录数: %4")
+    return QString("文件号: %1\n描述: %2\n总记录数: %3\n已写入记录数: %4\n内存占用: %5 字节")
             .arg(file->fileNumber())
             .arg(file->description())
             .arg(file->totalRecords())
-            .arg(file->getAllRecords().size());
+            .arg(file->writtenRecordCount())
+            .arg(file->memoryUsage());
 }
 
 // 获取所有已写入的记录
 QMap<quint16, quint16> FileStore::getAllRecords(quint16 fileNumber, quint16 maxRecords) const
 {
-    QReadLocker locker(&m_lock);
     QMap<quint16, quint16> result;
     
-    if (!m_files.contains(fileNumber)) {
+    FileRecord *file = findFile(fileNumber);
+    if (!file) {
         return result;
     }
     
-    FileRecord *file = m_files[fileNumber];
-    QMap<quint16, QByteArray> records = file->getAllRecords();
+    QMap<quint16, QByteArray> records = file->getWrittenRecords(maxRecords);
     
-    int count = 0;
-    for (auto it = records.begin(); it != records.end() && count < maxRecords; ++it, ++count) {
+    for (auto it = records.begin(); it != records.end(); ++it) {
         quint16 recordNum = it.key();
         QByteArray data = it.value();
         
@@ -290,37 +733,59 @@ QMap<quint16, quint16> FileStore::getAllRecords(quint16 fileNumber, quint16 maxR
 
 QMap<quint16, QByteArray> FileStore::getAllRecordsRaw(quint16 fileNumber, quint16 maxRecords) const
 {
-    QReadLocker locker(&m_lock);
-    QMap<quint16, QByteArray> result;
-    
-    if (!m_files.contains(fileNumber)) {
-        return result;
+    FileRecord *file = findFile(fileNumber);
+    return file ? file->getWrittenRecords(maxRecords) : QMap<quint16, QByteArray>();
+}
+
+bool FileStore::readWrittenPage(quint16 fileNumber, int cursor, int maxRecords, QVector<int> *recordNumbers,
+                                QByteArray *data, int *nextCursor, int *writtenCount) const
+{
+    FileRecord *file = findFile(fileNumber);
+    if (!file) {
+        return false;
     }
-    
-    FileRecord *file = m_files[fileNumber];
-    QMap<quint16, QByteArray> records = file->getAllRecords();
-    
-    int count = 0;
-    for (auto it = records.begin(); it != records.end() && count < maxRecords; ++it, ++count) {
-        result[it.key()] = it.value();
+
+    *nextCursor = file->readWrittenPage(qMax(0, cursor), qMax(1, maxRecords), recordNumbers, data);
+    if (writtenCount) {
+        *writtenCount = file->writtenRecordCount();
     }
-    
-    return result;
+    return true;
 }
 
 // ========== FileAddressStore 实现 ==========
 
 FileAddressStore::FileAddressStore(QObject *parent)
     : QObject(parent)
+    , m_registers(ADDRESS_SPACE)
 {
 }
 
+void FileAddressStore::setCompression(bool enabled, int cachePages)
+{
+    QWriteLocker locker(&m_lock);
+    m_registers.setCompression(enabled, cachePages);
+}
+
 void FileAddressStore::initializeRegion(quint16 startAddress, quint16 count)
 {
     QWriteLocker locker(&m_lock);
-    for (quint16 i = 0; i < count; ++i) {
-        m_data[startAddress + i] = QByteArray(2, 0);
-    }
+    int first = qMin<int>(count, ADDRESS_SPACE - startAddress);
+    m_registers.fill(startAddress, first, 0);
+    m_registers.fill(0, count - first, 0);
+}
+
+bool FileAddressStore::readRegisters(quint16 startAddress, int count, char *out) const
+{
+    int first = qMin(count, ADDRESS_SPACE - startAddress);
+    const bool ok = m_registers.read(startAddress, first, out);
+    return m_registers.read(0, count - first, out + first * 2) && ok;
+}
+
+bool FileAddressStore::writeRegisters(quint16 startAddress, const char *data, int count)
+{
+    int first = qMin(count, ADDRESS_SPACE - startAddress);
+    return m_registers.write(startAddress, data, first)
+            && m_registers.write(0, data + first * 2, count - first);
 }
 
 QByteArray FileAddressStore::handleReadFile(const QByteArray &request)
@@ -330,7 +795,6 @@ QByteArray FileAddressStore::handleReadFile(const QByteArray &request)
         return buildErrorResponse(0xCB, IllegalDataValue);
     }
 
-    quint8 functionCode = static_cast<quint8>(request[0]);  // 203 (0xCB)
     quint16 startAddress = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 1));
     quint16 quantity = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 3));
 
@@ -339,22 +803,17 @@ QByteArray FileAddressStore::handleReadFile(const QByteArray &request)
         return buildErrorResponse(0xCB, IllegalDataValue);
     }
 
-    // 读取数据
+    // 构建响应：寄存器数据直接复制到响应缓冲区
+    QByteArray response(2 + quantity * 2, Qt::Uninitialized);
+    response[0] = static_cast<char>(0xCB);              // 功能码 203
+    response[1] = static_cast<char>(quantity * 2);      // 字节数
+
     QReadLocker locker(&m_lock);
-    QByteArray data;
-    for (quint16 i = 0; i < quantity; ++i) {
-        quint16 addr = startAddress + i;
-        QByteArray regData = m_data.value(addr, QByteArray(2, 0));
-        data.append(regData);
+    if (!readRegisters(startAddress, quantity, response.data() + 2)) {
+        return buildErrorResponse(0xCB, SlaveDeviceFailure);
     }
     locker.unlock();
 
-    // 构建响应
-    QByteArray response;
-    response.append(static_cast<char>(0xCB));           // 功能码 203
-    response.append(static_cast<char>(data.size()));    // 字节数
-    response.append(data);
-
     emit registerRead(startAddress, quantity);
     return response;
 }
@@ -366,41 +825,31 @@ QByteArray FileAddressStore::handleWriteFile(const QByteArray &request)
         return buildErrorResponse(0xCC, IllegalDataValue);
     }
 
-    quint8 functionCode = static_cast<quint8>(request[0]);  // 204 (0xCC)
     quint16 startAddress = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 1));
     quint16 quantity = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.data() + 3));
     quint8 byteCount = static_cast<quint8>(request[5]);
-    QByteArray data = request.mid(6);
+    int dataSize = request.size() - 6;
 
     // 验证请求
     if (quantity == 0 || quantity > 123) {
         return buildErrorResponse(0xCC, IllegalDataValue);
     }
 
-    if (byteCount != data.size() || byteCount != quantity * 2) {
+    if (byteCount != dataSize || byteCount != quantity * 2) {
         return buildErrorResponse(0xCC, IllegalDataValue);
     }
 
     // 写入数据
     QWriteLocker locker(&m_lock);
-    for (quint16 i = 0; i < quantity; ++i) {
-        quint16 addr = startAddress + i;
-        QByteArray regData = data.mid(i * 2, 2);
-        m_data[addr] = regData;
+    if (!writeRegisters(startAddress, request.constData() + 6, quantity)) {
+        return buildErrorResponse(0xCC, SlaveDeviceFailure);
     }
     locker.unlock();
 
-    emit registerWritten(startAddress, data.size());
+    emit registerWritten(startAddress, dataSize);
 
-    // 构建响应
-    QByteArray response;
-    response.append(static_cast<char>(0xCC));  // 功能码 204
-    quint16 addr = qToBigEndian(startAddress);
-    response.append(reinterpret_cast<const char*>(&addr), 2);
-    quint16 qty = qToBigEndian(quantity);
-    response.append(reinterpret_cast<const char*>(&qty), 2);
-
-    return response;
+    // 构建响应：回显地址和数量
+    return request.left(5);
 }
 
 QByteArray FileAddressStore::buildErrorResponse(quint8 errorCode, quint8 exceptionCode) const
@@ -415,13 +864,15 @@ QMap<quint16, QByteArray> FileAddressStore::getAddressData(quint16 startAddress,
 {
     QReadLocker locker(&m_lock);
     QMap<quint16, QByteArray> result;
-    
+
+    QByteArray data(count * 2, Qt::Uninitialized);
+    readRegisters(startAddress, count, data.data());
     for (quint16 i = 0; i < count; ++i) {
         quint16 addr = startAddress + i;
-        if (m_data.contains(addr)) {
-            result[addr] = m_data[addr];
+        if (m_registers.isWritten(addr)) {
+            result[addr] = data.mid(i * 2, 2);
         }
     }
-    
+
     return result;
 }
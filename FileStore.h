@@ -10,34 +10,62 @@
 
 #include <QObject>
 #include <QMap>
+#include <QMutex>
 #include <QReadWriteLock>
+#include <QThreadPool>
+#include <QVector>
+#include <atomic>
 #include "ModbusTypes.h"
+#include "RecordPageArray.h"
+
+class QFile;
+class QTimer;
 
 // 文件记录数据结构
 class FileRecord
 {
 public:
     FileRecord(quint16 fileNumber, quint16 totalRecords);
-
-    QByteArray readRecords(quint16 startRecord, quint16 length) const;
-    bool writeRecords(quint16 startRecord, const QByteArray &data);
+    ~FileRecord();
+
+    // 把记录映射到磁盘文件：文件为空时写入文件头（随下一次 flush 同步），否则校验文件头并沿用其中的数据
+    bool attachStorage(const QString &path);
+    // 读取磁盘文件头，用于启动时加载已有文件
+    static bool readStorageHeader(const QString &path, quint16 *fileNumber,
+                                  quint16 *totalRecords, QString *description);
+    // 把写过的页同步到磁盘（在后台线程调用，不持锁等待磁盘）
+    void flush();
+    // 页压缩（只对内存中的文件生效，已映射到磁盘的文件忽略）
+    void setCompression(bool enabled, int cachePages);
+    qsizetype memoryUsage() const;
+
+    // 读取 length 条记录（大端，每条 2 字节）到 out，范围非法或压缩页解压失败时返回 false
+    bool readRecords(quint16 startRecord, quint16 length, char *out) const;
+    // 写入 length 条记录（大端，每条 2 字节），范围非法或压缩页解压失败时返回 false
+    bool writeRecords(quint16 startRecord, const char *data, int length);
 
     quint16 fileNumber() const { return m_fileNumber; }
     quint16 totalRecords() const { return m_totalRecords; }
     QString description() const { return m_description; }
     void setDescription(const QString &desc) { m_description = desc; }
     
-    QMap<quint16, QByteArray> getAllRecords() const { 
-        QReadLocker locker(&m_lock);
-        return m_records; 
-    }
+    // 已写入的记录数，以及按记录号顺序的前 maxRecords 条已写入记录
+    int writtenRecordCount() const;
+    QMap<quint16, QByteArray> getWrittenRecords(int maxRecords) const;
+    // 分页读取已写入记录：从记录号 cursor 起最多 maxRecords 条（数据每条 2 字节），
+    // 返回下一页的起始记录号，-1 表示没有更多
+    int readWrittenPage(int cursor, int maxRecords, QVector<int> *recordNumbers, QByteArray *data) const;
 
 private:
     quint16 m_fileNumber;
     quint16 m_totalRecords;
     QString m_description;
-    QMap<quint16, QByteArray> m_records;  // 记录号 -> 2字节数据
+    RecordPageArray m_records;  // 按页连续存放的记录数据
     mutable QReadWriteLock m_lock;
+    QMutex m_storageMutex;      // 串行化 attachStorage
+    QFile *m_storageFile;       // 映射的磁盘文件，为空时记录只在内存中
+    uchar *m_mapped;
+    bool m_headerDirty;         // 新建的文件头尚未同步到磁盘
 };
 
 // 标准文件存储管理器（功能码 20/21）
@@ -52,12 +80,29 @@ public:
     bool createFile(quint16 fileNumber, const QString &description, quint16 totalRecords = 10000);
     QByteArray handleReadFileRecord(const QByteArray &request);
     QByteArray handleWriteFileRecord(const QByteArray &request);
+
+    // 按记录直接读写（文件传输等批量路径使用），写入时文件不存在则自动创建
+    bool readRecords(quint16 fileNumber, quint16 startRecord, quint16 length, char *out) const;
+    bool writeRecords(quint16 fileNumber, quint16 startRecord, const char *data, quint16 length);
+    // 文件的记录容量，文件不存在返回 -1
+    int fileRecordCount(quint16 fileNumber) const;
     
+    // 启用磁盘存储：加载目录中已有的文件，之后创建的文件都映射到该目录并在后台定期刷盘
+    bool setStorageDirectory(const QString &path);
+    void flushAll();
+
+    // 内存中的文件按页压缩，只保留最近访问的 cachePages 页解压；对已有和之后创建的文件都生效
+    void setCompression(bool enabled, int cachePages = RecordPageArray::DEFAULT_CACHE_PAGES);
+    qsizetype memoryUsage() const;
+
     // 查询功能
     QStringList getFileList() const;
     QString getFileInfo(quint16 fileNumber) const;
     QMap<quint16, quint16> getAllRecords(quint16 fileNumber, quint16 maxRecords = 100) const;
     QMap<quint16, QByteArray> getAllRecordsRaw(quint16 fileNumber, quint16 maxRecords = 100) const;
+    // 分页读取已写入记录，文件不存在返回 false；nextCursor 为 -1 表示没有更多
+    bool readWrittenPage(quint16 fileNumber, int cursor, int maxRecords, QVector<int> *recordNumbers,
+                         QByteArray *data, int *nextCursor, int *writtenCount = nullptr) const;
 
 signals:
     void fileRead(quint16 fileNumber, quint16 recordNumber, quint16 length);
@@ -65,9 +110,38 @@ signals:
 
 private:
     QByteArray buildErrorResponse(quint8 errorCode, quint8 exceptionCode) const;
-
-    QMap<quint16, FileRecord*> m_files;
-    mutable QReadWriteLock m_lock;
+    FileRecord *findFile(quint16 fileNumber) const;
+    FileRecord *fileForWrite(quint16 fileNumber);
+    FileRecord *newFile(quint16 fileNumber, const QString &description, quint16 totalRecords,
+                        bool deferStorage = false);
+    QVector<FileRecord*> allFiles() const;
+    QString storagePath(quint16 fileNumber) const;
+    void scheduleFlush();
+
+    // 文件号 -> FileRecord 的两级直接索引：高 8 位选分片，低 8 位选槽位。
+    // 查找只做两次原子读取，不加锁；文件只增不删，创建由 m_createMutex 串行化
+    struct FileShard
+    {
+        std::atomic<FileRecord*> slots[256];
+    };
+
+    // FileRecord 按块分配（placement new），析构时整块释放
+    static constexpr int FILE_SLAB_SIZE = 32;
+    struct FileSlab
+    {
+        alignas(FileRecord) unsigned char storage[FILE_SLAB_SIZE][sizeof(FileRecord)];
+        int used = 0;
+    };
+
+    std::atomic<FileShard*> m_shards[256];
+    std::atomic<int> m_fileCount;
+    QVector<FileSlab*> m_slabs;
+    QMutex m_createMutex;       // 保护文件创建、m_slabs、m_storageDir 和压缩设置
+    QString m_storageDir;       // 为空表示只在内存中保存
+    bool m_compression;
+    int m_compressionCachePages;
+    QTimer *m_flushTimer;
+    QThreadPool m_flushPool;    // 单线程，刷盘和请求自动创建文件的落盘都不阻塞请求处理
 };
 
 // 地址文件存储管理器（功能码 203/204）
@@ -85,14 +159,22 @@ public:
     // 查询功能
     QMap<quint16, QByteArray> getAddressData(quint16 startAddress, quint16 count) const;
 
+    // 页压缩（默认关闭）：只保留最近访问的 cachePages 页解压，访问分散时每次请求都要压缩/解压
+    void setCompression(bool enabled, int cachePages = RecordPageArray::DEFAULT_CACHE_PAGES);
+
 signals:
     void registerRead(quint16 address, quint16 count);
     void registerWritten(quint16 address, int dataSize);
 
 private:
     QByteArray buildErrorResponse(quint8 errorCode, quint8 exceptionCode) const;
+    // 按地址读写连续寄存器（大端，每个 2 字节），越过 0xFFFF 时回绕到 0；压缩页解压失败时返回 false
+    bool readRegisters(quint16 startAddress, int count, char *out) const;
+    bool writeRegisters(quint16 startAddress, const char *data, int count);
+
+    static constexpr int ADDRESS_SPACE = 65536;
 
-    QMap<quint16, QByteArray> m_data;  // 地址 -> 2字节数据
+    RecordPageArray m_registers;  // 整个 16 位地址空间，按页分配（可选压缩），已初始化或写过的地址记入位图
     mutable QReadWriteLock m_lock;
 };
 
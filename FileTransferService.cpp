@@ -0,0 +1,373 @@
+/**
+ * @file FileTransferService.cpp
+ * @brief 窗口化文件传输（功能码 0xCD）实现
+ *
+ * 请求格式：功能码(1) + 子命令(1) + 参数
+ *   打开：起始文件号(2) + 总字节数(4)       -> 会话ID(2) + 窗口块数(1) + 块字节数(1)
+ *   数据：会话ID(2) + 序号(4) + 字节数(1) + 数据 -> 会话ID(2) + 下一个期望序号(4)
+ *   提交：会话ID(2) + CRC32(4)            -> 会话ID(2) + 状态(1) + 下一个期望序号(4) + CRC32(4)
+ *   查询：会话ID(2)                        -> 会话ID(2) + 下一个期望序号(4) + 已收块数(4)
+ *   中止：会话ID(2)                        -> 回显
+ * 正常应答至少 4 字节；异常应答为 功能码 + 异常码 共 2 字节（与 0xCB/0xCC 相同，功能码最高位本身已置位）
+ */
+
+#include "FileTransferService.h"
+#include "FileStore.h"
+#include "ModbusCrc.h"
+#include <QtEndian>
+#include <QDebug>
+
+namespace {
+
+void appendBigEndian16(QByteArray &data, quint16 value)
+{
+    quint16 be = qToBigEndian(value);
+    data.append(reinterpret_cast<const char*>(&be), 2);
+}
+
+void appendBigEndian32(QByteArray &data, quint32 value)
+{
+    quint32 be = qToBigEndian(value);
+    data.append(reinterpret_cast<const char*>(&be), 4);
+}
+
+} // namespace
+
+FileTransferService::FileTransferService(FileStore *fileStore, QObject *parent)
+    : QObject(parent)
+    , m_fileStore(fileStore)
+    , m_nextSessionId(1)
+{
+    m_clock.start();
+}
+
+QByteArray FileTransferService::handleRequest(const QByteArray &request)
+{
+    if (request.size() < 2) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    switch (static_cast<quint8>(request[1])) {
+    case TransferOpen:
+        return handleOpen(request);
+    case TransferData:
+        return handleData(request);
+    case TransferCommit:
+        return handleCommit(request);
+    case TransferStatus:
+        return handleStatus(request);
+    case TransferAbort:
+        return handleAbort(request);
+    default:
+        return buildErrorResponse(IllegalFunction);
+    }
+}
+
+int FileTransferService::activeSessionCount() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sessions.size();
+}
+
+QByteArray FileTransferService::handleOpen(const QByteArray &request)
+{
+    if (request.size() < 8) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    const uchar *p = reinterpret_cast<const uchar*>(request.constData());
+    quint16 startFile = qFromBigEndian<quint16>(p + 2);
+    quint32 totalSize = qFromBigEndian<quint32>(p + 4);
+
+    if (totalSize == 0) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    // 数据从起始文件依次向后占用，不能超出文件号范围
+    const quint64 capacity = quint64(0x10000 - startFile) * ModbusConst::FILE_BYTES;
+    if (totalSize > capacity) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+
+    // 已存在但容量不同的文件放不下对应的数据段，打开时就拒绝；
+    // 会话期间文件仍可能被其他请求创建，数据块写入前会再次检查
+    if (!blobFits(startFile, 0, totalSize)) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+
+    expireSessions();
+
+    QMutexLocker locker(&m_mutex);
+    if (m_sessions.size() >= ModbusConst::FILE_TRANSFER_MAX_SESSIONS) {
+        return buildErrorResponse(SlaveDeviceBusy);
+    }
+
+    // 会话ID从 1 开始循环分配，跳过仍在使用的 ID
+    quint16 sessionId = m_nextSessionId;
+    while (sessionId == 0 || m_sessions.contains(sessionId)) {
+        ++sessionId;
+    }
+    m_nextSessionId = sessionId + 1;
+
+    Session session;
+    session.startFile = startFile;
+    session.totalSize = totalSize;
+    session.chunkCount = (totalSize + ModbusConst::FILE_TRANSFER_CHUNK_SIZE - 1)
+            / ModbusConst::FILE_TRANSFER_CHUNK_SIZE;
+    session.received = QBitArray(int(session.chunkCount));
+    session.lastActivityMs = m_clock.elapsed();
+    m_sessions.insert(sessionId, session);
+    locker.unlock();
+
+    emit transferStarted(sessionId, startFile, totalSize);
+
+    QByteArray response;
+    response.append(static_cast<char>(FileTransfer));
+    response.append(static_cast<char>(TransferOpen));
+    appendBigEndian16(response, sessionId);
+    response.append(static_cast<char>(ModbusConst::FILE_TRANSFER_WINDOW));
+    response.append(static_cast<char>(ModbusConst::FILE_TRANSFER_CHUNK_SIZE));
+    return response;
+}
+
+QByteArray FileTransferService::handleData(const QByteArray &request)
+{
+    if (request.size() < 9) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    const uchar *p = reinterpret_cast<const uchar*>(request.constData());
+    quint16 sessionId = qFromBigEndian<quint16>(p + 2);
+    quint32 sequence = qFromBigEndian<quint32>(p + 4);
+    int byteCount = p[8];
+    if (request.size() < 9 + byteCount) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end() || sequence >= it->chunkCount) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+
+    Session &session = it.value();
+    const quint32 offset = sequence * quint32(ModbusConst::FILE_TRANSFER_CHUNK_SIZE);
+    const int expectedSize = int(qMin<quint32>(ModbusConst::FILE_TRANSFER_CHUNK_SIZE,
+                                               session.totalSize - offset));
+    if (byteCount != expectedSize) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+    session.lastActivityMs = m_clock.elapsed();
+
+    // 重复块直接确认；超出窗口的块不接收，主站按确认序号重发
+    const bool inWindow = sequence < session.nextExpected + ModbusConst::FILE_TRANSFER_WINDOW;
+    if (sequence >= session.nextExpected && inWindow && !session.received.testBit(int(sequence))) {
+        if (!blobFits(session.startFile, offset, quint32(byteCount))) {
+            return buildErrorResponse(IllegalDataAddress);
+        }
+        if (!writeBlob(session.startFile, offset, request.constData() + 9, byteCount)) {
+            return buildErrorResponse(SlaveDeviceFailure);
+        }
+        session.received.setBit(int(sequence));
+        session.receivedCount++;
+        while (session.nextExpected < session.chunkCount
+               && session.received.testBit(int(session.nextExpected))) {
+            session.nextExpected++;
+        }
+    }
+
+    QByteArray response;
+    response.reserve(8);
+    response.append(static_cast<char>(FileTransfer));
+    response.append(static_cast<char>(TransferData));
+    appendBigEndian16(response, sessionId);
+    appendBigEndian32(response, session.nextExpected);
+    return response;
+}
+
+QByteArray FileTransferService::handleCommit(const QByteArray &request)
+{
+    if (request.size() < 8) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    const uchar *p = reinterpret_cast<const uchar*>(request.constData());
+    quint16 sessionId = qFromBigEndian<quint16>(p + 2);
+    quint32 expectedCrc = qFromBigEndian<quint32>(p + 4);
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_sessions.find(sessionId);
+    if (it == m_sessions.end()) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+
+    Session session = it.value();
+    const bool complete = session.receivedCount == session.chunkCount;
+    if (complete) {
+        m_sessions.erase(it);
+    } else {
+        it->lastActivityMs = m_clock.elapsed();
+    }
+    locker.unlock();
+
+    // 会话已移出会话表，读回全部数据计算 CRC32 时不持锁，不阻塞其他会话
+    CommitStatus status = CommitIncomplete;
+    quint32 crc = 0;
+    if (complete) {
+        crc = blobCrc32(session);
+        status = crc == expectedCrc ? CommitOk : CommitCrcMismatch;
+    }
+
+    if (status == CommitOk) {
+        emit transferFinished(sessionId, true,
+                              QString("文件传输完成: 文件 %1 起 %2 字节")
+                              .arg(session.startFile).arg(session.totalSize));
+    } else if (status == CommitCrcMismatch) {
+        emit transferFinished(sessionId, false,
+                              QString("文件传输 CRC32 校验失败: 期望 %1, 实际 %2")
+                              .arg(expectedCrc, 8, 16, QChar('0'))
+                              .arg(crc, 8, 16, QChar('0')));
+    }
+
+    QByteArray response;
+    response.reserve(13);
+    response.append(static_cast<char>(FileTransfer));
+    response.append(static_cast<char>(TransferCommit));
+    appendBigEndian16(response, sessionId);
+    response.append(static_cast<char>(status));
+    appendBigEndian32(response, session.nextExpected);
+    appendBigEndian32(response, crc);
+    return response;
+}
+
+QByteArray FileTransferService::handleStatus(const QByteArray &request)
+{
+    if (request.size() < 4) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    quint16 sessionId = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.constData() + 2));
+
+    QMutexLocker locker(&m_mutex);
+    auto it = m_sessions.constFind(sessionId);
+    if (it == m_sessions.constEnd()) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+
+    QByteArray response;
+    response.reserve(12);
+    response.append(static_cast<char>(FileTransfer));
+    response.append(static_cast<char>(TransferStatus));
+    appendBigEndian16(response, sessionId);
+    appendBigEndian32(response, it->nextExpected);
+    appendBigEndian32(response, it->receivedCount);
+    return response;
+}
+
+QByteArray FileTransferService::handleAbort(const QByteArray &request)
+{
+    if (request.size() < 4) {
+        return buildErrorResponse(IllegalDataValue);
+    }
+
+    quint16 sessionId = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(request.constData() + 2));
+
+    QMutexLocker locker(&m_mutex);
+    if (!m_sessions.remove(sessionId)) {
+        return buildErrorResponse(IllegalDataAddress);
+    }
+    locker.unlock();
+
+    emit transferFinished(sessionId, false, QStringLiteral("文件传输被主站中止"));
+    return request.left(4);
+}
+
+// 数据按每个文件 FILE_BYTES 字节排布，[offset, offset + size) 覆盖的已有文件
+// 必须是满容量文件；容量相同的已有文件直接覆盖，不存在的文件写入时创建
+bool FileTransferService::blobFits(quint16 startFile, quint32 offset, quint32 size) const
+{
+    const quint32 firstFile = offset / ModbusConst::FILE_BYTES;
+    const quint32 lastFile = (offset + size - 1) / ModbusConst::FILE_BYTES;
+    for (quint32 i = firstFile; i <= lastFile; ++i) {
+        const int records = m_fileStore->fileRecordCount(quint16(startFile + i));
+        if (records >= 0 && records != ModbusConst::MAX_FILE_RECORDS) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FileTransferService::writeBlob(quint16 startFile, quint32 offset, const char *data, int size)
+{
+    while (size > 0) {
+        const quint16 fileNumber = quint16(startFile + offset / ModbusConst::FILE_BYTES);
+        const int fileOffset = int(offset % ModbusConst::FILE_BYTES);
+        const int chunk = qMin(size, ModbusConst::FILE_BYTES - fileOffset);
+        const quint16 startRecord = quint16(fileOffset / 2);
+        const quint16 records = quint16(chunk / 2);
+
+        if (records > 0 && !m_fileStore->writeRecords(fileNumber, startRecord, data, records)) {
+            return false;
+        }
+
+        // 总字节数为奇数时，最后一条记录低字节补 0
+        if (chunk % 2) {
+            const char last[2] = { data[chunk - 1], 0 };
+            if (!m_fileStore->writeRecords(fileNumber, startRecord + records, last, 1)) {
+                return false;
+            }
+        }
+
+        data += chunk;
+        offset += quint32(chunk);
+        size -= chunk;
+    }
+    return true;
+}
+
+quint32 FileTransferService::blobCrc32(const Session &session) const
+{
+    QByteArray buffer(ModbusConst::FILE_BYTES, Qt::Uninitialized);
+    quint32 crc = 0;
+    quint32 remaining = session.totalSize;
+
+    for (quint16 fileNumber = session.startFile; remaining > 0; ++fileNumber) {
+        const int bytes = int(qMin<quint32>(remaining, ModbusConst::FILE_BYTES));
+        // 块写入时已自动创建文件，读取失败（文件不存在或压缩页解压失败）按全 0 计算，CRC 随之不一致
+        if (!m_fileStore->readRecords(fileNumber, 0, quint16((bytes + 1) / 2), buffer.data())) {
+            buffer.fill(0);
+        }
+        crc = ModbusCrc::crc32(buffer.constData(), bytes, crc);
+        remaining -= quint32(bytes);
+    }
+    return crc;
+}
+
+void FileTransferService::expireSessions()
+{
+    QList<quint16> expired;
+    const qint64 now = m_clock.elapsed();
+
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_sessions.begin(); it != m_sessions.end();) {
+        if (now - it->lastActivityMs > ModbusConst::FILE_TRANSFER_TIMEOUT_MS) {
+            expired.append(it.key());
+            it = m_sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    locker.unlock();
+
+    for (quint16 sessionId : std::as_const(expired)) {
+        emit transferFinished(sessionId, false, QStringLiteral("文件传输会话超时"));
+    }
+}
+
+QByteArray FileTransferService::buildErrorResponse(quint8 exceptionCode) const
+{
+    QByteArray response;
+    response.append(static_cast<char>(FileTransfer | 0x80));
+    response.append(static_cast<char>(exceptionCode));
+    return response;
+}
@@ -0,0 +1,79 @@
+/**
+ * @file FileTransferService.h
+ * @brief 窗口化文件传输（功能码 0xCD）头文件
+ *
+ * 主站先打开会话，再按序号发送固定大小的数据块，不必等待上一块应答，
+ * 最多允许 FILE_TRANSFER_WINDOW 块未确认；从站按累计确认回复下一个期望序号，
+ * 全部收齐后用 CRC32 校验整体数据。数据直接写入 FileStore，
+ * 从起始文件号的记录 0 开始，每个文件 20000 字节，超出部分依次写入后续文件
+ */
+
+#ifndef FILETRANSFERSERVICE_H
+#define FILETRANSFERSERVICE_H
+
+#include <QObject>
+#include <QBitArray>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QMutex>
+#include "ModbusTypes.h"
+
+class FileStore;
+
+// 窗口化文件传输服务
+class FileTransferService : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 提交结果
+    enum CommitStatus : quint8 {
+        CommitOk = 0x00,            // 数据完整且 CRC32 一致
+        CommitIncomplete = 0x01,    // 仍有数据块未收到，会话保留
+        CommitCrcMismatch = 0x02    // CRC32 不一致，会话关闭
+    };
+
+    explicit FileTransferService(FileStore *fileStore, QObject *parent = nullptr);
+
+    QByteArray handleRequest(const QByteArray &request);
+
+    int activeSessionCount() const;
+
+signals:
+    void transferStarted(quint16 sessionId, quint16 startFile, quint32 totalSize);
+    void transferFinished(quint16 sessionId, bool success, const QString &message);
+
+private:
+    struct Session
+    {
+        quint16 startFile = 0;
+        quint32 totalSize = 0;
+        quint32 chunkCount = 0;
+        quint32 nextExpected = 0;   // 之前的块都已收到（累计确认）
+        quint32 receivedCount = 0;
+        QBitArray received;         // 窗口内乱序到达的块
+        qint64 lastActivityMs = 0;
+    };
+
+    QByteArray handleOpen(const QByteArray &request);
+    QByteArray handleData(const QByteArray &request);
+    QByteArray handleCommit(const QByteArray &request);
+    QByteArray handleStatus(const QByteArray &request);
+    QByteArray handleAbort(const QByteArray &request);
+
+    // 把 blob 中 offset 起的数据写入对应文件（offset 为偶数，奇数结尾补 0）
+    bool blobFits(quint16 startFile, quint32 offset, quint32 size) const;
+    bool writeBlob(quint16 startFile, quint32 offset, const char *data, int size);
+    quint32 blobCrc32(const Session &session) const;
+    void expireSessions();
+
+    QByteArray buildErrorResponse(quint8 exceptionCode) const;
+
+    FileStore *m_fileStore;
+    QHash<quint16, Session> m_sessions;
+    quint16 m_nextSessionId;
+    QElapsedTimer m_clock;
+    mutable QMutex m_mutex;
+};
+
+#endif // FILETRANSFERSERVICE_H
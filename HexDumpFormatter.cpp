@@ -0,0 +1,57 @@
+/**
+ * @file HexDumpFormatter.cpp
+ * @brief 十六进制/ASCII 转储格式化器实现
+ */
+
+#include "HexDumpFormatter.h"
+
+void HexDumpFormatter::appendNumber(qint64 value, int width)
+{
+    char digits[24];
+    int length = 0;
+    quint64 magnitude = value < 0 ? 0 - quint64(value) : quint64(value);
+    do {
+        digits[sizeof(digits) - 1 - length++] = char('0' + magnitude % 10);
+        magnitude /= 10;
+    } while (magnitude);
+    if (value < 0) {
+        digits[sizeof(digits) - 1 - length++] = '-';
+    }
+
+    if (width > length) {
+        m_buffer.append(width - length, ' ');
+    }
+    m_buffer.append(digits + sizeof(digits) - length, length);
+}
+
+void HexDumpFormatter::appendHex(const char *data, int size, int width)
+{
+    static const char hexDigits[] = "0123456789ABCDEF";
+
+    const qsizetype start = m_buffer.size();
+    const int length = qMax(size * 3, width);
+    m_buffer.resize(start + length);
+
+    char *out = m_buffer.data() + start;
+    for (int i = 0; i < size; ++i) {
+        const uchar b = static_cast<uchar>(data[i]);
+        *out++ = hexDigits[b >> 4];
+        *out++ = hexDigits[b & 0x0F];
+        *out++ = ' ';
+    }
+    for (int i = size * 3; i < length; ++i) {
+        *out++ = ' ';
+    }
+}
+
+void HexDumpFormatter::appendAscii(const char *data, int size)
+{
+    const qsizetype start = m_buffer.size();
+    m_buffer.resize(start + size);
+
+    char *out = m_buffer.data() + start;
+    for (int i = 0; i < size; ++i) {
+        const char c = data[i];
+        out[i] = (c >= 32 && c <= 126) ? c : '.';
+    }
+}
@@ -0,0 +1,38 @@
+/**
+ * @file HexDumpFormatter.h
+ * @brief 十六进制/ASCII 转储格式化器头文件
+ *
+ * 按固定列宽直接写入预分配的 UTF-8 缓冲区，最后一次性转换为 QString，
+ * 代替逐字节 QString::arg 和 += 拼接
+ */
+
+#ifndef HEXDUMPFORMATTER_H
+#define HEXDUMPFORMATTER_H
+
+#include <QByteArray>
+#include <QString>
+
+class HexDumpFormatter
+{
+public:
+    explicit HexDumpFormatter(qsizetype reserveBytes = 4096) { m_buffer.reserve(reserveBytes); }
+
+    void appendText(const QString &text) { m_buffer.append(text.toUtf8()); }
+    void appendLatin1(const char *text) { m_buffer.append(text); }
+    void appendChar(char c, int count = 1) { m_buffer.append(count, c); }
+
+    // 十进制数，右对齐到 width 列
+    void appendNumber(qint64 value, int width = 0);
+    // 每字节 "XX "，不足 width 列补空格
+    void appendHex(const char *data, int size, int width = 0);
+    // 可打印字符原样输出，其余输出 '.'
+    void appendAscii(const char *data, int size);
+
+    qsizetype size() const { return m_buffer.size(); }
+    QString toString() const { return QString::fromUtf8(m_buffer); }
+
+private:
+    QByteArray m_buffer;
+};
+
+#endif // HEXDUMPFORMATTER_H
@@ -15,6 +15,10 @@ ApplicationWindow {
     // modbusServer 和 sensorManager 通过 C++ setContextProperty 注入
     // 不需要在这里声明
 
+    // 分页查询的下一页起点，-1 表示没有更多
+    property int fileNextCursor: -1
+    property int registerNextCursor: -1
+
     ColumnLayout {
         anchors.fill: parent
         anchors.margins: 15
@@ -32,7 +36,7 @@ ApplicationWindow {
                 spacing: 15
                 // TCP 控制
                 GroupBox {
-                    title: "TCP 模式"
+                    title: "TCP/UDP 模式"
                     Layout.fillWidth: true
                     Layout.fillHeight: true
 
@@ -51,7 +55,7 @@ ApplicationWindow {
                         Button {
                             id: startTcpButton
                             text: "启动 TCP"
-                            enabled: modbusServer && !modbusServer.running
+                            enabled: modbusServer && !modbusServer.tcpRunning
                             onClicked: {
                                 if (modbusServer) {
                                     var port = parseInt(tcpPortField.text)
@@ -71,6 +75,56 @@ ApplicationWindow {
                                 }
                             }
                         }
+
+                        Button {
+                            id: startUdpButton
+                            text: "启动 UDP"
+                            // UDP 与 TCP 使用同一端口号，可同时运行
+                            enabled: modbusServer !== null
+                            onClicked: {
+                                if (modbusServer) {
+                                    var port = parseInt(tcpPortField.text)
+                                    addLog("尝试启动 UDP 服务器，端口: " + port)
+                                    if (modbusServer.startUdp(port)) {
+                                        statusLabel.text = "UDP 服务器已启动"
+                                        addLog("UDP 服务器启动成功")
+                                    } else {
+                                        addLog("UDP 服务器启动失败")
+                                    }
+                                } else {
+                                    addLog("错误: ModbusServer 对象未初始化")
+                                }
+                            }
+                        }
+
+                        Label { text: "RTU over TCP 端口:" }
+                        TextField {
+                            id: rtuOverTcpPortField
+                            text: "4001"
+                            placeholderText: "4001"
+                            Layout.preferredWidth: 100
+                        }
+
+                        Button {
+                            id: startRtuOverTcpButton
+                            text: "启动 RTU over TCP"
+                            // 接收串口服务器透传的 RTU 帧（含 CRC），可同时接入多个网关
+                            enabled: modbusServer !== null
+                            onClicked: {
+                                if (modbusServer) {
+                                    var port = parseInt(rtuOverTcpPortField.text)
+                                    addLog("尝试启动 RTU over TCP 服务器，端口: " + port)
+                                    if (modbusServer.startRtuOverTcp(port)) {
+                                        statusLabel.text = "RTU over TCP 服务器已启动"
+                                        addLog("RTU over TCP 服务器启动成功")
+                                    } else {
+                                        addLog("RTU over TCP 服务器启动失败")
+                                    }
+                                } else {
+                                    addLog("错误: ModbusServer 对象未初始化")
+                                }
+                            }
+                        }
                     }
                 }
 
@@ -100,13 +154,27 @@ ApplicationWindow {
                             Layout. preferredWidth: 100
                         }
 
+                        Label { text: "从站地址:" }
+                        TextField {
+                            id: rtuSlaveIdsField
+                            text: ""
+                            placeholderText: "全部 (如 1,2,5)"
+                            Layout.preferredWidth: 120
+                        }
+
                         Button {
                             id: startRtuButton
                             text: "启动 RTU"
-                            enabled: modbusServer && !modbusServer.running
+                            // 可多次启动以同时服务多个串口，并可与 TCP 同时运行
+                            enabled: modbusServer !== null
                             onClicked: {
                                 if (modbusServer) {
                                     var baudRate = parseInt(baudRateCombo. currentText)
+                                    // 多站总线只应答列出的地址，留空表示全部应答
+                                    var slaveIds = rtuSlaveIdsField.text.split(",")
+                                        .map(function(s) { return parseInt(s.trim()) })
+                                        .filter(function(id) { return id >= 1 && id <= 247 })
+                                    modbusServer.setRtuSlaveIds(slaveIds)
                                     addLog("尝试启动 RTU 服务器，串口: " + rtuPortField. text + ", 波特率:  " + baudRate)
                                     if (modbusServer.startRtu(rtuPortField. text, baudRate)) {
                                         statusLabel.text = "RTU 服务器已启动"
@@ -189,7 +257,9 @@ ApplicationWindow {
                     id: modeLabel
                     text: {
                         if (!modbusServer) return "未知"
-                        return modbusServer.mode === 0 ? "TCP" : "RTU"
+                        if (modbusServer.activeTransports.length > 0)
+                            return modbusServer.activeTransports.join(" + ")
+                        return ["TCP", "RTU", "UDP", "RTU over TCP"][modbusServer.mode]
                     }
                     font.pixelSize: 14
                 }
@@ -319,7 +389,7 @@ ApplicationWindow {
                                                 from: 1; to: 126; value: 10; editable: true
                                                 Layout.fillWidth: true
                                                 ToolTip.visible: hovered
-                                                ToolTip.text: "Modbus标准限制：单次最多读取126个记录（252字节）"
+                                                ToolTip.text: "查询时为每页显示的记录数；Modbus标准限制单次最多读取126个记录（252字节）"
                                             }
                                         }
 
@@ -331,7 +401,7 @@ ApplicationWindow {
                                             Button {
                                                 text: "🔍 查询文件内容"
                                                 Layout.fillWidth: true
-                                                onClicked: queryFileContent()
+                                                onClicked: queryFileContent(recordNumberSpinBox.value)
                                                 // background: Rectangle {
                                                 //     color: parent.hovered ? "#3498db" : "#2980b9"
                                                 //     radius: 3
@@ -345,6 +415,16 @@ ApplicationWindow {
                                                 //     font.bold: false
                                                 // }
                                             }
+
+                                            Button {
+                                                text: "下一页"
+                                                Layout.fillWidth: true
+                                                enabled: root.fileNextCursor >= 0
+                                                onClicked: {
+                                                    recordNumberSpinBox.value = root.fileNextCursor
+                                                    queryFileContent(root.fileNextCursor)
+                                                }
+                                            }
                                         }
                                     }
                                 }
@@ -390,7 +470,17 @@ ApplicationWindow {
                                             Button {
                                                 text: "🔍 查询保持寄存器"
                                                 Layout.fillWidth: true
-                                                onClicked: queryAddressFileContent()
+                                                onClicked: queryAddressFileContent(fileAddressSpinBox.value)
+                                            }
+
+                                            Button {
+                                                text: "下一页"
+                                                Layout.fillWidth: true
+                                                enabled: root.registerNextCursor >= 0
+                                                onClicked: {
+                                                    fileAddressSpinBox.value = root.registerNextCursor
+                                                    queryAddressFileContent(root.registerNextCursor)
+                                                }
                                             }
                                         }
                                     }
@@ -866,55 +956,36 @@ ApplicationWindow {
 
     // 刷新数据显示
     // 查询文件内容
-    function queryFileContent() {
+    function queryFileContent(cursor) {
         if (!modbusServer) {
             addLog("错误: 服务器未初始化")
             return
         }
 
         var fileNum = fileNumberSpinBox.value
-        addLog("正在查询文件 " + fileNum + " 的内容...")
-        addLog("")
-
-        // 调用C++后端查询
-        var content = modbusServer.queryFileContent(fileNum, 50)
-
-        // 将内容按行输出到日志
-        var lines = content.split('\n')
-        for (var i = 0; i < lines.length; i++) {
-            if (lines[i].trim() !== "") {
-                addLog(lines[i])
-            }
-        }
+        addLog("正在查询文件 " + fileNum + " 的内容（记录 " + cursor + " 起）...")
 
-        addLog("")
+        // 调用C++后端分页查询，每次只取一页，整页一次追加到日志
+        var page = modbusServer.queryFilePage(fileNum, cursor, recordCountSpinBox.value)
+        root.fileNextCursor = page.nextCursor
+        addLog("\n" + page.text)
     }
 
     // 读取地址文件（模拟功能码 203）
     // 查询地址文件内容
-    function queryAddressFileContent() {
+    function queryAddressFileContent(startAddr) {
         if (!modbusServer) {
             addLog("错误: 服务器未初始化")
             return
         }
 
-        var startAddr = fileAddressSpinBox.value
         var count = fileRegisterCountSpinBox.value
         addLog("正在查询保持寄存器...")
-        addLog("")
 
         // 调用C++后端查询
-        var content = modbusServer.queryAddressFile(startAddr, count)
-
-        // 将内容按行输出到日志
-        var lines = content.split('\n')
-        for (var i = 0; i < lines.length; i++) {
-            if (lines[i].trim() !== "") {
-                addLog(lines[i])
-            }
-        }
-
-        addLog("")
+        var page = modbusServer.queryRegisterPage(startAddr, count)
+        root.registerNextCursor = page.nextCursor
+        addLog("\n" + page.text)
     }
 
     // 显示传感器列表
@@ -937,27 +1008,12 @@ ApplicationWindow {
 
         var startTime = new Date().getTime()
         
+        // 当前值由 C++ 一次快照、批量解码得到，顺序与传感器列表一致
+        var currentValues = modbusServer ? sensorManager.readCurrentValues(modbusServer) : []
+        
         for (var i = 0; i < sensors.length; i++) {
             var sensor = sensors[i]
-            var currentVal = ""
-            
-            // 获取当前值
-            if (modbusServer && modbusServer.dataStore) {
-                try {
-                    if (sensor.pointType === "线圈") {
-                        currentVal = modbusServer.dataStore.readCoil(sensor.index) ? "1" : "0"
-                    } else if (sensor.pointType === "离散输入") {
-                        currentVal = modbusServer.dataStore.readDiscreteInput(sensor.index) ? "1" : "0"
-                    } else if (sensor.pointType === "保持寄存器") {
-                        currentVal = readRegisterValue(sensor.index, sensor.valueType, true)
-                    } else if (sensor.pointType === "输入寄存器") {
-                        currentVal = readRegisterValue(sensor.index, sensor.valueType, false)
-                    }
-                } catch (e) {
-                    console.log("读取传感器值出错 - 地址:", sensor.index, "错误:", e)
-                    currentVal = "错误"
-                }
-            }
+            var currentVal = i < currentValues.length ? currentValues[i] : ""
             
             sensorListModel.append({
                 "address": sensor.index,
@@ -979,111 +1035,6 @@ ApplicationWindow {
         console.log("===== displaySensorList 完成，添加了", sensorListModel.count, "条记录，耗时:", (endTime - startTime), "ms =====")
     }
 
-    // 根据值类型读取寄存器值
-    function readRegisterValue(address, valueType, isHolding) {
-        if (!modbusServer || !modbusServer.dataStore) {
-            return ""
-        }
-
-        var readFunc = isHolding ? 
-            modbusServer.dataStore.readHoldingRegister : 
-            modbusServer.dataStore.readInputRegister
-
-        switch (valueType) {
-        case "UINT16":
-            return String(readFunc(address))
-        case "INT16":
-            var val = readFunc(address)
-            // 转换为有符号整数
-            return String(val > 32767 ? val - 65536 : val)
-        case "FLOAT32":
-        case "FLOAT":
-            var high = readFunc(address)
-            var low = readFunc(address + 1)
-            return registersToFloat(high, low).toFixed(6)
-        case "FLOAT64":
-        case "DOUBLE":
-            var r0 = readFunc(address)
-            var r1 = readFunc(address + 1)
-            var r2 = readFunc(address + 2)
-            var r3 = readFunc(address + 3)
-            return registersToDouble(r0, r1, r2, r3).toFixed(12)
-        case "UINT64":
-            var r0 = readFunc(address)
-            var r1 = readFunc(address + 1)
-            var r2 = readFunc(address + 2)
-            var r3 = readFunc(address + 3)
-            // 避免位运算的有符号转换问题，使用乘法
-            var high32 = r0 * 65536 + r1  // 前32位
-            var low32 = r2 * 65536 + r3   // 后32位
-            // JavaScript 精度限制，大于 2^53 会丢失精度
-            var result = high32 * 4294967296 + low32
-            return String(Math.round(result))
-        case "INT64":
-            var r0 = readFunc(address)
-            var r1 = readFunc(address + 1)
-            var r2 = readFunc(address + 2)
-            var r3 = readFunc(address + 3)
-            
-            // 先组合高32位
-            var high32 = r0 * 65536 + r1
-            // 检查符号位，如果是负数需要转换为有符号的32位数
-            if (r0 >= 32768) {
-                high32 = high32 - 4294967296  // 转换为负数
-            }
-            
-            // 组合低32位（始终是正数）
-            var low32 = r2 * 65536 + r3
-            
-            // 最终计算：有符号的高32位 * 2^32 + 无符号的低32位
-            var result = high32 * 4294967296 + low32
-            
-            console.log("INT64读取 - 地址:", address, "寄存器:[", r0, r1, r2, r3, "] 高32位:", high32, "低32位:", low32, "结果:", result)
-            
-            return String(Math.round(result))
-        case "UINT32":
-            var high = readFunc(address)
-            var low = readFunc(address + 1)
-            // 使用乘法避免位运算的有符号问题
-            return String(high * 65536 + low)
-        case "INT32":
-            var high = readFunc(address)
-            var low = readFunc(address + 1)
-            var uint32Val = high * 65536 + low
-            // 转换为有符号整数
-            return String(uint32Val > 2147483647 ? uint32Val - 4294967296 : uint32Val)
-        default:
-            return String(readFunc(address))
-        }
-    }
-
-    // 辅助函数：将两个寄存器转换为 float
-    function registersToFloat(high, low) {
-        var uint32Val = (high << 16) | low
-        var buffer = new ArrayBuffer(4)
-        var intView = new Uint32Array(buffer)
-        var floatView = new Float32Array(buffer)
-        intView[0] = uint32Val
-        return floatView[0]
-    }
-
-    // 辅助函数：将四个寄存器转换为 double
-    function registersToDouble(r0, r1, r2, r3) {
-        // 构造 64 位整数（JavaScript 使用两个 32 位数）
-        var high32 = (r0 << 16) | r1
-        var low32 = (r2 << 16) | r3
-        
-        var buffer = new ArrayBuffer(8)
-        var intView = new Uint32Array(buffer)
-        var floatView = new Float64Array(buffer)
-        
-        // 大端序：高位在前
-        intView[1] = high32  // 高32位
-        intView[0] = low32   // 低32位
-        
-        return floatView[0]
-    }
-
     // 更新线圈值
     function updateCoilValue(address, value) {
         console.log("收到线圈变化信号 - 地址:", address, "值:", value)
@@ -1115,7 +1066,7 @@ ApplicationWindow {
         for (var i = 0; i < sensorListModel.count; i++) {
             var item = sensorListModel.get(i)
             if (item.address === address && item.pointType === pointType) {
-                var displayValue = readRegisterValue(address, item.valueType || "UINT16", isHolding)
+                var displayValue = sensorManager.readCurrentValue(modbusServer, i)
                 console.log("找到匹配项，索引:", i, "值类型:", item.valueType, "显示值:", displayValue)
                 sensorListModel.setProperty(i, "currentValue", displayValue)
                 found = true
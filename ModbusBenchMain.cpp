@@ -0,0 +1,102 @@
+/**
+ * @file ModbusBenchMain.cpp
+ * @brief 控制台测试与基准程序入口
+ *
+ * 不创建界面，可在无显示的 Linux 和 CI 中运行；
+ *   --crc  校验各 CRC16 实现（逐位/查表/slice-by-8/PCLMUL 折叠）与 CRC32，并输出吞吐量
+ *   --rtu  伪终端 RTU 端到端测试（仅 Linux）
+ *   --rtu-tcp  经 RTU over TCP 完成一次 0xCD 文件传输（仅 Linux）
+ * 不带参数时运行全部测试；任一项失败返回 1，当前平台不支持时返回 77（CTest 记为跳过）
+ */
+
+#include <QCoreApplication>
+#include <QDebug>
+#include "ModbusCrc.h"
+#include "ModbusServer.h"
+#include "ModbusRtuBench.h"
+
+namespace {
+
+constexpr int EXIT_SKIPPED = 77;
+
+// 各实现与逐位参考实现逐一比对，再测吞吐量
+int runCrcBench()
+{
+    bool ok = ModbusCrc::selfTest();
+    qInfo().noquote() << ModbusCrc::benchmark();
+    qInfo() << "CRC 自检" << (ok ? "通过" : "失败");
+    return ok ? 0 : 1;
+}
+
+// 伪终端对代替串口，测量请求到应答的延迟分布和帧率
+int runRtuBench()
+{
+    if (!ModbusRtuBench::isSupported()) {
+        qInfo() << "RTU 测试台需要 Linux 伪终端支持，跳过";
+        return EXIT_SKIPPED;
+    }
+
+    // 文件只保存在内存中，不触碰用户数据目录
+    ModbusServer server;
+    server.initializeData();
+
+    bool ok = false;
+    ModbusRtuBench bench(&server);
+    qInfo().noquote() << bench.run({ 9600, 19200, 38400, 115200 }, 1000, &ok);
+    server.stop();
+    return ok ? 0 : 1;
+}
+
+// 数据块帧长度取决于第 9 字节，验证 RTU over TCP 能按长度字节成帧并完成传输
+int runRtuTcpTransfer()
+{
+    if (!ModbusRtuBench::isSupported()) {
+        qInfo() << "RTU over TCP 传输测试需要 Linux，跳过";
+        return EXIT_SKIPPED;
+    }
+
+    ModbusServer server;
+    server.initializeData();
+
+    bool ok = false;
+    ModbusRtuBench bench(&server);
+    qInfo().noquote() << bench.runTransferOverTcp(&ok);
+    server.stop();
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    const QStringList args = app.arguments().mid(1);
+    const bool all = args.isEmpty();
+
+    int ran = 0;
+    int skipped = 0;
+    bool failed = false;
+    auto record = [&](int result) {
+        ++ran;
+        if (result == EXIT_SKIPPED) {
+            ++skipped;
+        } else if (result != 0) {
+            failed = true;
+        }
+    };
+
+    if (all || args.contains(QStringLiteral("--crc"))) {
+        record(runCrcBench());
+    }
+    if (all || args.contains(QStringLiteral("--rtu"))) {
+        record(runRtuBench());
+    }
+    if (all || args.contains(QStringLiteral("--rtu-tcp"))) {
+        record(runRtuTcpTransfer());
+    }
+
+    if (failed) {
+        return 1;
+    }
+    return ran > 0 && skipped == ran ? EXIT_SKIPPED : 0;
+}
@@ -0,0 +1,420 @@
+/**
+ * @file ModbusCrc.cpp
+ * @brief Modbus CRC16 计算引擎实现
+ */
+
+#include "ModbusCrc.h"
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QtEndian>
+#include <QDebug>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define MODBUS_CRC_FOLDING_X86
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define MODBUS_CRC_TARGET_CLMUL
+#else
+#define MODBUS_CRC_TARGET_CLMUL __attribute__((target("pclmul,sse2")))
+#endif
+#elif defined(__aarch64__) && (defined(__ARM_FEATURE_CRYPTO) || defined(__ARM_FEATURE_AES))
+// AArch64 上 PMULL 属于加密扩展，只在编译目标已启用时使用（Apple 芯片默认启用）
+#define MODBUS_CRC_FOLDING_ARM
+#include <arm_neon.h>
+#endif
+
+namespace {
+
+constexpr quint16 CRC_INIT = 0xFFFF;
+constexpr quint16 CRC_POLY_REFLECTED = 0xA001;  // x^16 + x^15 + x^2 + 1 的反射形式
+constexpr quint32 CRC_POLY = 0x18005;           // 同一多项式的正常形式（含 x^16）
+constexpr qsizetype FOLDING_MIN_SIZE = 64;      // 短帧折叠的准备开销大于收益
+
+using CrcFunction = quint16 (*)(quint16 crc, const uchar *data, qsizetype size);
+
+// slice-by-8 查表：table[k][b] 为字节 b 后跟 k 个零字节时的 CRC 贡献，table[0] 即普通 256 项表
+struct CrcTables
+{
+    quint16 table[8][256] = {};
+
+    constexpr CrcTables()
+    {
+        for (int b = 0; b < 256; ++b) {
+            quint16 crc = static_cast<quint16>(b);
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? static_cast<quint16>((crc >> 1) ^ CRC_POLY_REFLECTED)
+                                : static_cast<quint16>(crc >> 1);
+            }
+            table[0][b] = crc;
+        }
+        for (int k = 1; k < 8; ++k) {
+            for (int b = 0; b < 256; ++b) {
+                quint16 prev = table[k - 1][b];
+                table[k][b] = static_cast<quint16>((prev >> 8) ^ table[0][prev & 0xFF]);
+            }
+        }
+    }
+};
+
+constexpr CrcTables CRC_TABLES;
+
+quint16 crcBitwise(quint16 crc, const uchar *data, qsizetype size)
+{
+    for (qsizetype i = 0; i < size; ++i) {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; ++bit) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ CRC_POLY_REFLECTED;
+            } else {
+                crc >>= 1;
+            }
+        }
+    }
+    return crc;
+}
+
+quint16 crcTable(quint16 crc, const uchar *data, qsizetype size)
+{
+    const quint16 *table = CRC_TABLES.table[0];
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = (crc >> 8) ^ table[(crc ^ data[i]) & 0xFF];
+    }
+    return crc;
+}
+
+quint16 crcSlice8(quint16 crc, const uchar *data, qsizetype size)
+{
+    const auto &t = CRC_TABLES.table;
+
+    // CRC 寄存器只有 16 位，异或进 8 字节块的前两个字节后各字节独立查表
+    while (size >= 8) {
+        quint64 word;
+        std::memcpy(&word, data, sizeof(word));
+        word = qFromLittleEndian(word) ^ crc;
+        crc = t[7][word & 0xFF] ^ t[6][(word >> 8) & 0xFF]
+            ^ t[5][(word >> 16) & 0xFF] ^ t[4][(word >> 24) & 0xFF]
+            ^ t[3][(word >> 32) & 0xFF] ^ t[2][(word >> 40) & 0xFF]
+            ^ t[1][(word >> 48) & 0xFF] ^ t[0][word >> 56];
+        data += 8;
+        size -= 8;
+    }
+    return crcTable(crc, data, size);
+}
+
+#if defined(MODBUS_CRC_FOLDING_X86) || defined(MODBUS_CRC_FOLDING_ARM)
+
+// x^n mod P（正常形式，次数 < 16）
+constexpr quint32 xPowModPoly(int n)
+{
+    quint32 r = 1;
+    for (int i = 0; i < n; ++i) {
+        r <<= 1;
+        if (r & 0x10000) {
+            r ^= CRC_POLY;
+        }
+    }
+    return r;
+}
+
+// 反射域中 64 位 × 64 位无进位乘法的乘积整体右移了 1 位，
+// 因此常数取 x^(n-1) mod P，并按位反射到 64 位字的高端
+constexpr quint64 foldConstant(int n)
+{
+    quint32 k = xPowModPoly(n - 1);
+    quint64 c = 0;
+    for (int j = 0; j < 16; ++j) {
+        if (k & (1u << j)) {
+            c |= quint64(1) << (63 - j);
+        }
+    }
+    return c;
+}
+
+// 一个 128 位块折叠到下一块：低 64 位（高次项）乘 x^192，高 64 位乘 x^128
+constexpr quint64 FOLD_LOW = foldConstant(192);
+constexpr quint64 FOLD_HIGH = foldConstant(128);
+
+#endif
+
+#if defined(MODBUS_CRC_FOLDING_X86)
+
+MODBUS_CRC_TARGET_CLMUL
+quint16 crcFolding(quint16 crc, const uchar *data, qsizetype size)
+{
+    if (size < 32) {
+        return crcSlice8(crc, data, size);
+    }
+
+    // 初值异或进首块，之后每 16 字节折叠一次，折叠结果与原消息模 P 同余
+    const __m128i k = _mm_set_epi64x(static_cast<long long>(FOLD_HIGH), static_cast<long long>(FOLD_LOW));
+    __m128i acc = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    acc = _mm_xor_si128(acc, _mm_cvtsi32_si128(crc));
+    data += 16;
+    size -= 16;
+
+    while (size >= 16) {
+        __m128i low = _mm_clmulepi64_si128(acc, k, 0x00);
+        __m128i high = _mm_clmulepi64_si128(acc, k, 0x11);
+        acc = _mm_xor_si128(_mm_xor_si128(low, high),
+                            _mm_loadu_si128(reinterpret_cast<const __m128i*>(data)));
+        data += 16;
+        size -= 16;
+    }
+
+    // 剩余 16 字节累加器和尾部数据用查表完成最终约简
+    alignas(16) uchar folded[16];
+    _mm_store_si128(reinterpret_cast<__m128i*>(folded), acc);
+    crc = crcSlice8(0, folded, sizeof(folded));
+    return crcSlice8(crc, data, size);
+}
+
+bool cpuSupportsFolding()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 1);
+    return (info[2] & (1 << 1)) != 0;  // ECX.PCLMULQDQ
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("pclmul");
+#endif
+}
+
+#elif defined(MODBUS_CRC_FOLDING_ARM)
+
+quint16 crcFolding(quint16 crc, const uchar *data, qsizetype size)
+{
+    if (size < 32) {
+        return crcSlice8(crc, data, size);
+    }
+
+    const poly64_t kLow = static_cast<poly64_t>(FOLD_LOW);
+    const poly64_t kHigh = static_cast<poly64_t>(FOLD_HIGH);
+    uint64x2_t acc = vreinterpretq_u64_u8(vld1q_u8(data));
+    acc = veorq_u64(acc, vsetq_lane_u64(crc, vdupq_n_u64(0), 0));
+    data += 16;
+    size -= 16;
+
+    while (size >= 16) {
+        poly128_t low = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(acc, 0)), kLow);
+        poly128_t high = vmull_p64(static_cast<poly64_t>(vgetq_lane_u64(acc, 1)), kHigh);
+        acc = veorq_u64(veorq_u64(vreinterpretq_u64_p128(low), vreinterpretq_u64_p128(high)),
+                        vreinterpretq_u64_u8(vld1q_u8(data)));
+        data += 16;
+        size -= 16;
+    }
+
+    uchar folded[16];
+    vst1q_u8(folded, vreinterpretq_u8_u64(acc));
+    crc = crcSlice8(0, folded, sizeof(folded));
+    return crcSlice8(crc, data, size);
+}
+
+bool cpuSupportsFolding()
+{
+    return true;
+}
+
+#endif
+
+CrcFunction implementationFunction(ModbusCrc::Implementation impl)
+{
+    switch (impl) {
+    case ModbusCrc::Bitwise:
+        return crcBitwise;
+    case ModbusCrc::Slice8:
+        return crcSlice8;
+    case ModbusCrc::Folding:
+#if defined(MODBUS_CRC_FOLDING_X86) || defined(MODBUS_CRC_FOLDING_ARM)
+        if (ModbusCrc::isSupported(ModbusCrc::Folding)) {
+            return crcFolding;
+        }
+#endif
+        return crcTable;
+    case ModbusCrc::Table:
+    default:
+        return crcTable;
+    }
+}
+
+// CRC32（IEEE 802.3，反射多项式 0xEDB88320），用于文件传输的整体校验
+struct Crc32Table
+{
+    quint32 table[256] = {};
+
+    constexpr Crc32Table()
+    {
+        for (quint32 b = 0; b < 256; ++b) {
+            quint32 crc = b;
+            for (int bit = 0; bit < 8; ++bit) {
+                crc = (crc & 1) ? (crc >> 1) ^ 0xEDB88320u : crc >> 1;
+            }
+            table[b] = crc;
+        }
+    }
+};
+
+constexpr Crc32Table CRC32_TABLE;
+
+// 启动时选定长帧实现；折叠实现先与查表结果核对一次，不一致则放弃
+ModbusCrc::Implementation selectImplementation()
+{
+    if (ModbusCrc::isSupported(ModbusCrc::Folding)) {
+        uchar probe[FOLDING_MIN_SIZE + 13];
+        for (size_t i = 0; i < sizeof(probe); ++i) {
+            probe[i] = static_cast<uchar>(i * 131 + 7);
+        }
+        CrcFunction folding = implementationFunction(ModbusCrc::Folding);
+        if (folding(CRC_INIT, probe, sizeof(probe)) == crcTable(CRC_INIT, probe, sizeof(probe))) {
+            return ModbusCrc::Folding;
+        }
+        qWarning() << "CRC 折叠实现校验失败，改用 slice-by-8";
+    }
+    return ModbusCrc::Slice8;
+}
+
+} // namespace
+
+// ========== ModbusCrc 实现 ==========
+
+quint16 ModbusCrc::compute(const char *data, qsizetype size)
+{
+    static const CrcFunction longFrameFunction = implementationFunction(activeImplementation());
+
+    const uchar *bytes = reinterpret_cast<const uchar*>(data);
+    return size >= FOLDING_MIN_SIZE ? longFrameFunction(CRC_INIT, bytes, size)
+                                    : crcSlice8(CRC_INIT, bytes, size);
+}
+
+quint16 ModbusCrc::compute(Implementation impl, const char *data, qsizetype size)
+{
+    return implementationFunction(impl)(CRC_INIT, reinterpret_cast<const uchar*>(data), size);
+}
+
+quint32 ModbusCrc::crc32(const char *data, qsizetype size, quint32 crc)
+{
+    const uchar *bytes = reinterpret_cast<const uchar*>(data);
+    crc = ~crc;
+    for (qsizetype i = 0; i < size; ++i) {
+        crc = (crc >> 8) ^ CRC32_TABLE.table[(crc ^ bytes[i]) & 0xFF];
+    }
+    return ~crc;
+}
+
+bool ModbusCrc::isSupported(Implementation impl)
+{
+    if (impl != Folding) {
+        return true;
+    }
+#if defined(MODBUS_CRC_FOLDING_X86) || defined(MODBUS_CRC_FOLDING_ARM)
+    static const bool supported = cpuSupportsFolding();
+    return supported;
+#else
+    return false;
+#endif
+}
+
+ModbusCrc::Implementation ModbusCrc::activeImplementation()
+{
+    static const Implementation active = selectImplementation();
+    return active;
+}
+
+QString ModbusCrc::implementationName(Implementation impl)
+{
+    switch (impl) {
+    case Bitwise: return QStringLiteral("bitwise");
+    case Table:   return QStringLiteral("table");
+    case Slice8:  return QStringLiteral("slice-by-8");
+#if defined(MODBUS_CRC_FOLDING_ARM)
+    case Folding: return QStringLiteral("pmull-fold");
+#else
+    case Folding: return QStringLiteral("pclmul-fold");
+#endif
+    }
+    return QString();
+}
+
+bool ModbusCrc::selfTest()
+{
+    // 标准校验值：CRC16/MODBUS("123456789") = 0x4B37
+    static const char check[] = "123456789";
+    if (compute(Bitwise, check, 9) != 0x4B37) {
+        qWarning() << "CRC 参考实现校验值错误";
+        return false;
+    }
+    // CRC32("123456789") = 0xCBF43926，分段累加结果应与整段一致
+    if (crc32(check, 9) != 0xCBF43926u || crc32(check + 4, 5, crc32(check, 4)) != 0xCBF43926u) {
+        qWarning() << "CRC32 校验值错误";
+        return false;
+    }
+
+    // 伪随机数据，覆盖 0..300 字节所有长度以及非对齐起始地址
+    QByteArray data(301 + 7, Qt::Uninitialized);
+    quint32 seed = 0x12345678;
+    for (char &c : data) {
+        seed = seed * 1103515245u + 12345u;
+        c = static_cast<char>(seed >> 24);
+    }
+
+    const Implementation impls[] = { Table, Slice8, Folding };
+    for (int offset = 0; offset < 8; ++offset) {
+        for (qsizetype len = 0; len <= 300; ++len) {
+            const char *p = data.constData() + offset;
+            quint16 expected = compute(Bitwise, p, len);
+            if (compute(p, len) != expected) {
+                qWarning() << "CRC 校验失败: 默认实现, 长度" << len << "偏移" << offset;
+                return false;
+            }
+            for (Implementation impl : impls) {
+                if (isSupported(impl) && compute(impl, p, len) != expected) {
+                    qWarning() << "CRC 校验失败:" << implementationName(impl)
+                               << "长度" << len << "偏移" << offset;
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+QString ModbusCrc::benchmark(int frameSize, int iterations)
+{
+    QByteArray frame(qMax(1, frameSize), Qt::Uninitialized);
+    for (int i = 0; i < frame.size(); ++i) {
+        frame[i] = static_cast<char>(i * 37 + 11);
+    }
+
+    QStringList lines;
+    lines << QString("CRC16 基准测试: 帧长 %1 字节, %2 次, 默认实现 %3")
+             .arg(frame.size()).arg(iterations).arg(implementationName(activeImplementation()));
+
+    const Implementation impls[] = { Bitwise, Table, Slice8, Folding };
+    for (Implementation impl : impls) {
+        if (!isSupported(impl)) {
+            lines << QString("  %1: 不支持").arg(implementationName(impl), -12);
+            continue;
+        }
+
+        // 逐位实现很慢，减少次数避免测试耗时过长
+        const int count = (impl == Bitwise) ? qMax(1, iterations / 10) : iterations;
+        quint16 sink = 0;
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < count; ++i) {
+            frame[0] = static_cast<char>(sink);  // 结果参与下一轮输入，防止被优化掉
+            sink ^= compute(impl, frame.constData(), frame.size());
+        }
+        const qint64 ns = qMax<qint64>(1, timer.nsecsElapsed());
+
+        const double bytes = double(count) * frame.size();
+        lines << QString("  %1: %2 MB/s, %3 ns/帧 (sink %4)")
+                 .arg(implementationName(impl), -12)
+                 .arg(bytes * 1000.0 / ns, 0, 'f', 1)
+                 .arg(double(ns) / count, 0, 'f', 1)
+                 .arg(sink, 4, 16, QChar('0'));
+    }
+    return lines.join('\n');
+}
@@ -0,0 +1,50 @@
+/**
+ * @file ModbusCrc.h
+ * @brief Modbus CRC16 计算引擎头文件
+ *
+ * 提供逐位参考实现、256 项查表、slice-by-8 和 PCLMUL/PMULL 折叠四种实现，
+ * 运行时按 CPU 能力选用；全部直接作用于指针 + 长度，不拷贝数据
+ */
+
+#ifndef MODBUSCRC_H
+#define MODBUSCRC_H
+
+#include <QByteArray>
+#include <QString>
+
+// CRC16/MODBUS（初值 0xFFFF，反射多项式 0xA001，无结果异或）
+class ModbusCrc
+{
+public:
+    enum Implementation {
+        Bitwise,    // 逐位计算（参考实现）
+        Table,      // 256 项查表，每字节一次
+        Slice8,     // slice-by-8，每次 8 字节
+        Folding     // 无进位乘法折叠（x86-64 PCLMUL / AArch64 PMULL）
+    };
+
+    // 使用当前 CPU 上最快的实现计算
+    static quint16 compute(const char *data, qsizetype size);
+    static quint16 compute(const QByteArray &data) { return compute(data.constData(), data.size()); }
+
+    // 使用指定实现计算（用于校验和基准测试），不支持的实现退回查表
+    static quint16 compute(Implementation impl, const char *data, qsizetype size);
+
+    // CRC32（IEEE，与 zlib 相同），crc 传入上一段的结果即可分段累加
+    static quint32 crc32(const char *data, qsizetype size, quint32 crc = 0);
+
+    static bool isSupported(Implementation impl);
+    static Implementation activeImplementation();  // 长帧使用的实现
+    static QString implementationName(Implementation impl);
+
+    // 与逐位参考实现逐一比对各长度、各实现的结果，全部一致返回 true
+    static bool selfTest();
+
+    // 对各实现做吞吐量测试，返回可读的结果报告
+    static QString benchmark(int frameSize = 256, int iterations = 200000);
+
+private:
+    ModbusCrc() = delete;
+};
+
+#endif // MODBUSCRC_H
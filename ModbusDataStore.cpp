@@ -1,5 +1,6 @@
 #include "ModbusDataStore.h"
 #include <QDebug>
+#include <algorithm>
 
 ModbusDataStore::ModbusDataStore(QObject *parent)
     : QObject(parent)
@@ -255,3 +256,42 @@ void ModbusDataStore::clearAll()
         m_inputRegisters.clear();
     }
 }
+
+// ========== 快照 ==========
+
+namespace {
+
+template <typename Map, typename T>
+void copyToImage(const Map &map, T *image)
+{
+    std::fill(image, image + 65536, T(0));
+    for (auto it = map.constBegin(); it != map.constEnd(); ++it) {
+        image[it.key()] = T(it.value());
+    }
+}
+
+} // namespace
+
+void ModbusDataStore::snapshotCoils(quint8 *image) const
+{
+    QReadLocker locker(&m_coilsLock);
+    copyToImage(m_coils, image);
+}
+
+void ModbusDataStore::snapshotDiscreteInputs(quint8 *image) const
+{
+    QReadLocker locker(&m_discreteInputsLock);
+    copyToImage(m_discreteInputs, image);
+}
+
+void ModbusDataStore::snapshotHoldingRegisters(quint16 *image) const
+{
+    QReadLocker locker(&m_holdingRegistersLock);
+    copyToImage(m_holdingRegisters, image);
+}
+
+void ModbusDataStore::snapshotInputRegisters(quint16 *image) const
+{
+    QReadLocker locker(&m_inputRegistersLock);
+    copyToImage(m_inputRegisters, image);
+}
@@ -46,6 +46,12 @@ public:
     // 清空所有数据
     void clearAll();
 
+    // 整个地址空间的快照（image 至少 65536 项，未设置的地址为 0），用于批量解码点位
+    void snapshotCoils(quint8 *image) const;
+    void snapshotDiscreteInputs(quint8 *image) const;
+    void snapshotHoldingRegisters(quint16 *image) const;
+    void snapshotInputRegisters(quint16 *image) const;
+
 signals:
     void coilChanged(quint16 address, bool value);
     void discreteInputChanged(quint16 address, bool value);
@@ -0,0 +1,80 @@
+/**
+ * @file ModbusLoadControl.cpp
+ * @brief 过载保护实现
+ */
+
+#include "ModbusLoadControl.h"
+
+// ========== TokenBucket 实现 ==========
+
+TokenBucket::TokenBucket(double ratePerSecond, double burst)
+    : m_rate(0.0)
+    , m_burst(0.0)
+    , m_tokens(0.0)
+    , m_lastMs(-1)
+{
+    configure(ratePerSecond, burst);
+}
+
+void TokenBucket::configure(double ratePerSecond, double burst)
+{
+    m_rate = ratePerSecond;
+    m_burst = qMax(1.0, burst);
+    m_tokens = m_burst;
+    m_lastMs = -1;
+}
+
+bool TokenBucket::tryConsume(qint64 nowMs)
+{
+    if (m_rate <= 0.0) {
+        return true;
+    }
+
+    // 按经过的时间补充令牌，最多补满桶容量
+    if (m_lastMs >= 0) {
+        m_tokens = qMin(m_burst, m_tokens + (nowMs - m_lastMs) * m_rate / 1000.0);
+    }
+    m_lastMs = nowMs;
+
+    if (m_tokens < 1.0) {
+        return false;
+    }
+    m_tokens -= 1.0;
+    return true;
+}
+
+// ========== EventLoopLagMonitor 实现 ==========
+
+EventLoopLagMonitor::EventLoopLagMonitor(QObject *parent)
+    : QObject(parent)
+    , m_lastTickMs(0)
+    , m_lagMs(0.0)
+{
+    m_timer.setTimerType(Qt::PreciseTimer);
+    connect(&m_timer, &QTimer::timeout, this, &EventLoopLagMonitor::onTick);
+}
+
+void EventLoopLagMonitor::start(int intervalMs)
+{
+    m_lagMs = 0.0;
+    m_clock.start();
+    m_lastTickMs = 0;
+    m_timer.start(intervalMs);
+}
+
+void EventLoopLagMonitor::stop()
+{
+    m_timer.stop();
+    m_lagMs = 0.0;
+}
+
+void EventLoopLagMonitor::onTick()
+{
+    qint64 now = m_clock.elapsed();
+    qint64 lag = qMax<qint64>(0, now - m_lastTickMs - m_timer.interval());
+    m_lastTickMs = now;
+
+    // 指数加权平均：上升快、下降慢，避免单次抖动触发限流
+    double alpha = (lag > m_lagMs) ? 0.5 : 0.1;
+    m_lagMs += alpha * (lag - m_lagMs);
+}
@@ -0,0 +1,58 @@
+/**
+ * @file ModbusLoadControl.h
+ * @brief 过载保护头文件
+ *
+ * 提供令牌桶限流和事件循环延迟监测，用于服务器的准入控制
+ */
+
+#ifndef MODBUSLOADCONTROL_H
+#define MODBUSLOADCONTROL_H
+
+#include <QObject>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 令牌桶：按固定速率补充令牌，每个请求消耗一个令牌
+class TokenBucket
+{
+public:
+    TokenBucket(double ratePerSecond = 0.0, double burst = 0.0);
+
+    // ratePerSecond <= 0 表示不限流
+    void configure(double ratePerSecond, double burst);
+    bool tryConsume(qint64 nowMs);
+    bool isLimited() const { return m_rate > 0.0; }
+
+private:
+    double m_rate;      // 每秒补充的令牌数
+    double m_burst;     // 桶容量（允许的突发请求数）
+    double m_tokens;
+    qint64 m_lastMs;
+};
+
+// 事件循环延迟监测：定时器实际触发时间与预期时间的差值即为事件循环积压
+class EventLoopLagMonitor : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit EventLoopLagMonitor(QObject *parent = nullptr);
+
+    void start(int intervalMs = 20);
+    void stop();
+    bool isActive() const { return m_timer.isActive(); }
+
+    // 平滑后的事件循环延迟（毫秒）
+    qint64 lagMs() const { return static_cast<qint64>(m_lagMs); }
+
+private slots:
+    void onTick();
+
+private:
+    QTimer m_timer;
+    QElapsedTimer m_clock;
+    qint64 m_lastTickMs;
+    double m_lagMs;
+};
+
+#endif // MODBUSLOADCONTROL_H
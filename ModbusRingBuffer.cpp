@@ -0,0 +1,92 @@
+/**
+ * @file ModbusRingBuffer.cpp
+ * @brief 接收环形缓冲区实现
+ */
+
+#include "ModbusRingBuffer.h"
+#include <QIODevice>
+#include <cstring>
+
+ModbusRingBuffer::ModbusRingBuffer(qsizetype capacity)
+    : m_data(nullptr)
+    , m_capacity(16)
+    , m_head(0)
+    , m_size(0)
+{
+    // 容量取2的幂，回绕时只需按位与
+    while (m_capacity < capacity) {
+        m_capacity <<= 1;
+    }
+    m_mask = m_capacity - 1;
+    m_storage.resize(m_capacity);
+    m_data = m_storage.data();
+}
+
+qsizetype ModbusRingBuffer::readFrom(QIODevice *device)
+{
+    qsizetype total = 0;
+
+    // 空闲区最多分成两段（环尾 + 环头），逐段直接读入
+    while (freeSpace() > 0) {
+        qsizetype tail = (m_head + m_size) & m_mask;
+        qsizetype contiguous = qMin(freeSpace(), m_capacity - tail);
+
+        qint64 got = device->read(m_data + tail, contiguous);
+        if (got <= 0) {
+            break;
+        }
+
+        m_size += got;
+        total += got;
+        if (got < contiguous) {
+            break;  // 设备已读空
+        }
+    }
+
+    return total;
+}
+
+qsizetype ModbusRingBuffer::append(const char *data, qsizetype length)
+{
+    qsizetype n = qMin(length, freeSpace());
+    qsizetype tail = (m_head + m_size) & m_mask;
+    qsizetype first = qMin(n, m_capacity - tail);
+
+    std::memcpy(m_data + tail, data, first);
+    std::memcpy(m_data, data + first, n - first);
+    m_size += n;
+
+    return n;
+}
+
+QByteArray ModbusRingBuffer::frameView(qsizetype length, QByteArray &scratch) const
+{
+    Q_ASSERT(length <= m_size);
+
+    // 帧未跨越环尾：直接引用缓冲区内存
+    if (m_head + length <= m_capacity) {
+        return QByteArray::fromRawData(m_data + m_head, length);
+    }
+
+    // 帧跨越环尾：拼接到复用的 scratch 中（容量不变时不会重新分配）
+    qsizetype first = m_capacity - m_head;
+    scratch.resize(length);
+    std::memcpy(scratch.data(), m_data + m_head, first);
+    std::memcpy(scratch.data() + first, m_data, length - first);
+    return scratch;
+}
+
+void ModbusRingBuffer::consume(qsizetype n)
+{
+    n = qMin(n, m_size);
+    m_size -= n;
+
+    // 缓冲区清空时回到起点，使后续帧尽量保持连续
+    m_head = (m_size == 0) ? 0 : ((m_head + n) & m_mask);
+}
+
+void ModbusRingBuffer::clear()
+{
+    m_head = 0;
+    m_size = 0;
+}
@@ -0,0 +1,57 @@
+/**
+ * @file ModbusRingBuffer.h
+ * @brief 接收环形缓冲区头文件
+ *
+ * 为每个连接提供固定容量的环形接收缓冲区，支持原地帧视图，避免逐帧拷贝和内存搬移
+ */
+
+#ifndef MODBUSRINGBUFFER_H
+#define MODBUSRINGBUFFER_H
+
+#include <QByteArray>
+#include <QtGlobal>
+
+class QIODevice;
+
+// 固定容量环形缓冲区（容量向上取整为2的幂，下标用掩码回绕）
+class ModbusRingBuffer
+{
+public:
+    explicit ModbusRingBuffer(qsizetype capacity = 4096);
+    Q_DISABLE_COPY(ModbusRingBuffer)
+
+    qsizetype size() const { return m_size; }
+    qsizetype capacity() const { return m_capacity; }
+    qsizetype freeSpace() const { return m_capacity - m_size; }
+    bool isEmpty() const { return m_size == 0; }
+    bool isFull() const { return m_size == m_capacity; }
+
+    // 从设备直接读入空闲区（无中间QByteArray），返回读取的字节数
+    qsizetype readFrom(QIODevice *device);
+
+    // 追加数据，超出空闲区的部分被丢弃，返回实际写入的字节数
+    qsizetype append(const char *data, qsizetype length);
+
+    // 按偏移查看数据（offset 必须小于 size()）
+    quint8 at(qsizetype offset) const { return static_cast<quint8>(m_data[(m_head + offset) & m_mask]); }
+    quint16 peekUInt16BE(qsizetype offset) const { return quint16(at(offset) << 8) | at(offset + 1); }
+
+    // 获取缓冲区头部 length 字节的帧视图：
+    // 数据连续时返回 fromRawData 零拷贝视图，跨越环尾时拷贝到 scratch 中
+    // 视图在下一次 consume()/readFrom()/append() 之前有效
+    QByteArray frameView(qsizetype length, QByteArray &scratch) const;
+
+    // 丢弃头部 n 字节
+    void consume(qsizetype n);
+    void clear();
+
+private:
+    QByteArray m_storage;
+    char *m_data;
+    qsizetype m_capacity;
+    qsizetype m_mask;
+    qsizetype m_head;   // 第一个有效字节的位置
+    qsizetype m_size;   // 有效字节数
+};
+
+#endif // MODBUSRINGBUFFER_H
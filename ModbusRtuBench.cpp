@@ -0,0 +1,407 @@
+/**
+ * @file ModbusRtuBench.cpp
+ * @brief RTU 伪终端测试台实现
+ */
+
+#include "ModbusRtuBench.h"
+#include "ModbusServer.h"
+#include "ModbusRtuPort.h"
+#include "ModbusCrc.h"
+#include "ModbusTypes.h"
+#include "FileTransferService.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include <QtEndian>
+#include <algorithm>
+
+#ifdef Q_OS_LINUX
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <termios.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+// 打开伪终端主端，返回文件描述符，slaveName 为从端设备路径
+int openPty(QString &slaveName, QString &error)
+{
+    int fd = ::posix_openpt(O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (fd < 0 || ::grantpt(fd) != 0 || ::unlockpt(fd) != 0) {
+        error = QString("打开伪终端失败: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+
+    char name[128];
+    if (::ptsname_r(fd, name, sizeof(name)) != 0) {
+        error = QString("获取伪终端从端失败: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        ::close(fd);
+        return -1;
+    }
+
+    slaveName = QString::fromLocal8Bit(name);
+    return fd;
+}
+
+QByteArray appendCrc(QByteArray frame)
+{
+    quint16 crcLe = qToLittleEndian(ModbusRtuPort::calculateCRC(frame));
+    frame.append(reinterpret_cast<const char*>(&crcLe), 2);
+    return frame;
+}
+
+QByteArray rtuFrame(std::initializer_list<quint8> body)
+{
+    QByteArray frame;
+    for (quint8 b : body) {
+        frame.append(static_cast<char>(b));
+    }
+    return appendCrc(frame);
+}
+
+bool rtuCrcValid(const QByteArray &frame)
+{
+    if (frame.size() < 4) {
+        return false;
+    }
+    quint16 receivedCrc = qFromLittleEndian<quint16>(
+                reinterpret_cast<const uchar*>(frame.constData() + frame.size() - 2));
+    return ModbusRtuPort::calculateCRC(frame.constData(), frame.size() - 2) == receivedCrc;
+}
+
+bool writeAll(int fd, const QByteArray &data)
+{
+    qsizetype written = 0;
+    while (written < data.size()) {
+        ssize_t n = ::write(fd, data.constData() + written, size_t(data.size() - written));
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        written += n;
+    }
+    return true;
+}
+
+// 读满 length 字节或超时，返回实际读到的字节数；
+// 服务端在本线程事件循环中收发时（RTU over TCP）需要 pumpEvents
+int readExact(int fd, char *buffer, int length, int timeoutMs, bool pumpEvents = false)
+{
+    QElapsedTimer timer;
+    timer.start();
+    int received = 0;
+    while (received < length) {
+        int remaining = timeoutMs - int(timer.elapsed());
+        if (remaining <= 0) {
+            break;
+        }
+        if (pumpEvents) {
+            QCoreApplication::processEvents(QEventLoop::AllEvents, 5);
+            remaining = 0;
+        }
+        pollfd pfd = { fd, POLLIN, 0 };
+        if (::poll(&pfd, 1, remaining) <= 0) {
+            continue;
+        }
+        ssize_t n = ::read(fd, buffer + received, size_t(length - received));
+        if (n > 0) {
+            received += int(n);
+        } else if (n < 0 && errno != EINTR && errno != EAGAIN) {
+            break;
+        }
+    }
+    return received;
+}
+
+// 连接本机 TCP 端口，返回套接字描述符
+int connectLocal(quint16 port, QString &error)
+{
+    int fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    sockaddr_in addr = {};
+    addr.sin_family = AF_INET;
+    addr.sin_port = htons(port);
+    addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        error = QString("连接 RTU over TCP 端口失败: %1").arg(QString::fromLocal8Bit(strerror(errno)));
+        if (fd >= 0) {
+            ::close(fd);
+        }
+        return -1;
+    }
+    return fd;
+}
+
+// 发送一帧并等待固定长度的应答，应答不完整或 CRC 错误时返回空
+QByteArray transact(int fd, const QByteArray &request, int responseLength)
+{
+    if (!writeAll(fd, request)) {
+        return QByteArray();
+    }
+    QByteArray response(responseLength, Qt::Uninitialized);
+    if (readExact(fd, response.data(), responseLength, 2000, true) != responseLength
+            || !rtuCrcValid(response)) {
+        return QByteArray();
+    }
+    return response;
+}
+
+double percentile(const QVector<qint64> &sorted, double p)
+{
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    int index = qBound(0, int(p * (sorted.size() - 1) + 0.5), int(sorted.size() - 1));
+    return sorted.at(index) / 1000.0;
+}
+
+} // namespace
+#endif // Q_OS_LINUX
+
+ModbusRtuBench::ModbusRtuBench(ModbusServer *server)
+    : m_server(server)
+{
+}
+
+bool ModbusRtuBench::isSupported()
+{
+#ifdef Q_OS_LINUX
+    return true;
+#else
+    return false;
+#endif
+}
+
+QString ModbusRtuBench::run(const QList<int> &baudRates, int framesPerRun, bool *ok)
+{
+    QStringList lines;
+    bool success = true;
+
+    if (!isSupported()) {
+        if (ok) {
+            *ok = false;
+        }
+        return QStringLiteral("RTU 测试台需要 Linux 伪终端支持");
+    }
+
+    QList<Result> results;
+    for (int baudRate : baudRates) {
+        QString error;
+        if (!runBaudRate(baudRate, framesPerRun, results, error)) {
+            lines << QString("波特率 %1 测试失败: %2").arg(baudRate).arg(error);
+            success = false;
+        }
+    }
+
+    lines.prepend(QString("RTU 伪终端测试台: 每组 %1 帧 (伪终端无线路延迟，测得的是帧判定与处理开销)")
+                  .arg(framesPerRun));
+    for (const Result &r : std::as_const(results)) {
+        lines << QString("  %1 @%2: %3 帧, 失败 %4, 平均 %5us, P50 %6us, P99 %7us, 最大 %8us, %9 帧/秒")
+                 .arg(r.label, -18).arg(r.baudRate, -6).arg(r.frames).arg(r.failures)
+                 .arg(r.avgUs, 0, 'f', 1).arg(r.p50Us, 0, 'f', 1).arg(r.p99Us, 0, 'f', 1)
+                 .arg(r.maxUs, 0, 'f', 1).arg(r.framesPerSecond, 0, 'f', 0);
+        if (r.failures > 0) {
+            success = false;
+        }
+    }
+
+    if (ok) {
+        *ok = success;
+    }
+    return lines.join('\n');
+}
+
+bool ModbusRtuBench::runBaudRate(int baudRate, int framesPerRun, QList<Result> &results, QString &error)
+{
+#ifdef Q_OS_LINUX
+    QString slaveName;
+    int fd = openPty(slaveName, error);
+    if (fd < 0) {
+        return false;
+    }
+
+    if (!m_server->startRtu(slaveName, baudRate)) {
+        error = m_server->statusMessage();
+        ::close(fd);
+        return false;
+    }
+
+    // 长度规则可推断的请求：读 10 个保持寄存器，收齐即成帧
+    QByteArray readRequest = rtuFrame({ 0x01, 0x03, 0x00, 0x00, 0x00, 0x0A });
+    results << measure(fd, QStringLiteral("FC03 读10寄存器"), baudRate, framesPerRun,
+                       readRequest, 5 + 10 * 2);
+
+    // 长度规则未知的功能码：只能等 t3.5 静默期成帧，应答非法功能异常
+    QByteArray unknownRequest = rtuFrame({ 0x01, 0x41, 0x00, 0x00 });
+    results << measure(fd, QStringLiteral("未知功能码 (t3.5)"), baudRate, qMax(1, framesPerRun / 4),
+                       unknownRequest, 5);
+
+    m_server->stopRtuPort(slaveName);
+    ::close(fd);
+    return true;
+#else
+    Q_UNUSED(baudRate);
+    Q_UNUSED(framesPerRun);
+    Q_UNUSED(results);
+    error = QStringLiteral("不支持的平台");
+    return false;
+#endif
+}
+
+QString ModbusRtuBench::runTransferOverTcp(bool *ok)
+{
+    QString error;
+    bool success = transferOverTcp(error);
+    if (ok) {
+        *ok = success;
+    }
+    return success
+            ? QStringLiteral("RTU over TCP 文件传输: 打开/数据块/提交 通过")
+            : QString("RTU over TCP 文件传输失败: %1").arg(error);
+}
+
+bool ModbusRtuBench::transferOverTcp(QString &error)
+{
+#ifdef Q_OS_LINUX
+    // 端口 0 由系统分配，避免与已运行的实例冲突
+    if (!m_server->startRtuOverTcp(0)) {
+        error = m_server->statusMessage();
+        return false;
+    }
+
+    int fd = connectLocal(m_server->rtuOverTcpPort(), error);
+    if (fd < 0) {
+        m_server->stopRtuOverTcp();
+        return false;
+    }
+
+    // 一个完整数据块：数据块的长度字节在第 9 字节，帧长度推断需要读到这里才能成帧
+    const quint16 startFile = 0xF000;
+    QByteArray payload(ModbusConst::FILE_TRANSFER_CHUNK_SIZE, Qt::Uninitialized);
+    for (int i = 0; i < payload.size(); ++i) {
+        payload[i] = static_cast<char>(i * 7 + 3);
+    }
+
+    auto finish = [&](const QString &message) {
+        error = message;
+        ::close(fd);
+        m_server->stopRtuOverTcp();
+        return message.isEmpty();
+    };
+
+    QByteArray open;
+    open.append(char(0x01)).append(char(FileTransfer)).append(char(TransferOpen));
+    open.append(char(startFile >> 8)).append(char(startFile & 0xFF));
+    const quint32 totalSize = quint32(payload.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        open.append(char((totalSize >> shift) & 0xFF));
+    }
+    // 应答：地址 + 功能码 + 子命令 + 会话ID(2) + 窗口 + 块大小 + CRC
+    QByteArray response = transact(fd, appendCrc(open), 9);
+    if (response.isEmpty() || quint8(response[1]) != FileTransfer) {
+        return finish(QStringLiteral("打开会话无应答或应答异常"));
+    }
+    const quint16 sessionId = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(response.constData() + 3));
+
+    QByteArray data;
+    data.append(char(0x01)).append(char(FileTransfer)).append(char(TransferData));
+    data.append(char(sessionId >> 8)).append(char(sessionId & 0xFF));
+    data.append(4, char(0));
+    data.append(char(payload.size()));
+    data.append(payload);
+    // 应答：地址 + 功能码 + 子命令 + 会话ID(2) + 下一个期望序号(4) + CRC
+    response = transact(fd, appendCrc(data), 11);
+    if (response.isEmpty() || quint8(response[1]) != FileTransfer
+            || qFromBigEndian<quint32>(reinterpret_cast<const uchar*>(response.constData() + 5)) != 1) {
+        return finish(QStringLiteral("数据块无应答或确认序号错误"));
+    }
+
+    QByteArray commit;
+    commit.append(char(0x01)).append(char(FileTransfer)).append(char(TransferCommit));
+    commit.append(char(sessionId >> 8)).append(char(sessionId & 0xFF));
+    const quint32 crc = ModbusCrc::crc32(payload.constData(), payload.size());
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        commit.append(char((crc >> shift) & 0xFF));
+    }
+    // 应答：地址 + 功能码 + 子命令 + 会话ID(2) + 状态 + 序号(4) + CRC32(4) + CRC
+    response = transact(fd, appendCrc(commit), 16);
+    if (response.isEmpty() || quint8(response[1]) != FileTransfer
+            || quint8(response[5]) != FileTransferService::CommitOk) {
+        return finish(QStringLiteral("提交无应答或校验失败"));
+    }
+
+    return finish(QString());
+#else
+    error = QStringLiteral("不支持的平台");
+    return false;
+#endif
+}
+
+ModbusRtuBench::Result ModbusRtuBench::measure(int masterFd, const QString &label, int baudRate,
+                                               int frames, const QByteArray &request, int responseLength)
+{
+    Result result;
+    result.label = label;
+    result.baudRate = baudRate;
+
+#ifdef Q_OS_LINUX
+    QVector<qint64> latencies;
+    latencies.reserve(frames);
+    QByteArray response(responseLength, Qt::Uninitialized);
+
+    QElapsedTimer total;
+    total.start();
+    for (int i = 0; i < frames; ++i) {
+        QElapsedTimer timer;
+        timer.start();
+        if (!writeAll(masterFd, request)) {
+            result.failures++;
+            continue;
+        }
+
+        int received = readExact(masterFd, response.data(), responseLength, 1000);
+        qint64 ns = timer.nsecsElapsed();
+
+        // 应答必须完整且 CRC 正确，否则清空残留数据后继续
+        if (received != responseLength || !rtuCrcValid(response)) {
+            result.failures++;
+            ::tcflush(masterFd, TCIOFLUSH);
+            continue;
+        }
+        latencies.append(ns);
+    }
+    const qint64 elapsedNs = qMax<qint64>(1, total.nsecsElapsed());
+
+    result.frames = int(latencies.size());
+    if (!latencies.isEmpty()) {
+        std::sort(latencies.begin(), latencies.end());
+        qint64 sum = 0;
+        for (qint64 ns : std::as_const(latencies)) {
+            sum += ns;
+        }
+        result.avgUs = sum / 1000.0 / latencies.size();
+        result.p50Us = percentile(latencies, 0.50);
+        result.p99Us = percentile(latencies, 0.99);
+        result.maxUs = latencies.last() / 1000.0;
+        result.framesPerSecond = result.frames * 1e9 / elapsedNs;
+    }
+#else
+    Q_UNUSED(masterFd);
+    Q_UNUSED(frames);
+    Q_UNUSED(request);
+    Q_UNUSED(responseLength);
+#endif
+
+    return result;
+}
@@ -0,0 +1,55 @@
+/**
+ * @file ModbusRtuBench.h
+ * @brief RTU 伪终端测试台头文件
+ *
+ * 用 Linux 伪终端对代替真实串口：从端交给 ModbusServer::startRtu，
+ * 主端由内置 RTU 主站收发请求，测量请求到应答的延迟和帧率；
+ * 另经 RTU over TCP 走一遍 0xCD 文件传输，覆盖依赖长度字节成帧的数据块
+ */
+
+#ifndef MODBUSRTUBENCH_H
+#define MODBUSRTUBENCH_H
+
+#include <QList>
+#include <QString>
+
+class ModbusServer;
+
+// RTU 端到端基准测试（仅 Linux）
+class ModbusRtuBench
+{
+public:
+    // 一组测试的统计结果
+    struct Result
+    {
+        QString label;
+        int baudRate = 0;
+        int frames = 0;         // 收到应答的帧数
+        int failures = 0;       // 超时或应答错误
+        double avgUs = 0.0;
+        double p50Us = 0.0;
+        double p99Us = 0.0;
+        double maxUs = 0.0;
+        double framesPerSecond = 0.0;
+    };
+
+    explicit ModbusRtuBench(ModbusServer *server);
+
+    // 对每个波特率依次测试，返回可读的结果报告；失败时 ok 置为 false
+    QString run(const QList<int> &baudRates, int framesPerRun, bool *ok = nullptr);
+
+    // 经 RTU over TCP 完成一次 0xCD 文件传输（打开/数据块/提交），返回结果说明
+    QString runTransferOverTcp(bool *ok = nullptr);
+
+    static bool isSupported();
+
+private:
+    bool transferOverTcp(QString &error);
+    bool runBaudRate(int baudRate, int framesPerRun, QList<Result> &results, QString &error);
+    Result measure(int masterFd, const QString &label, int baudRate, int frames,
+                   const QByteArray &request, int responseLength);
+
+    ModbusServer *m_server;
+};
+
+#endif // MODBUSRTUBENCH_H
@@ -0,0 +1,149 @@
+/**
+ * @file ModbusRtuFrameParser.cpp
+ * @brief Modbus RTU 流式帧解析器实现
+ */
+
+#include "ModbusRtuFrameParser.h"
+#include "ModbusRtuPort.h"
+#include "ModbusTypes.h"
+#include <QtEndian>
+
+// 待解析数据超过该值时视为持续噪声，丢弃最早的字节
+static constexpr qsizetype MAX_PENDING_BYTES = 4 * ModbusConst::MAX_RTU_ADU_SIZE;
+
+// ========== RtuAddressFilter 实现 ==========
+
+void RtuAddressFilter::setAddresses(const QList<int> &addresses)
+{
+    quint64 bits[4] = { 0, 0, 0, 0 };
+    if (addresses.isEmpty()) {
+        bits[0] = bits[1] = bits[2] = bits[3] = ~quint64(0);
+    }
+    for (int address : addresses) {
+        if (address >= 1 && address <= 247) {
+            bits[address >> 6] |= quint64(1) << (address & 63);
+        }
+    }
+    for (int i = 0; i < 4; ++i) {
+        m_bits[i].store(bits[i], std::memory_order_relaxed);
+    }
+}
+
+// ========== ModbusRtuFrameParser 实现 ==========
+
+void ModbusRtuFrameParser::append(const char *data, qsizetype size)
+{
+    // 已解析部分在追加前一次性移除，之前返回的帧视图随之失效
+    if (m_head > 0) {
+        m_buffer.remove(0, m_head);
+        m_head = 0;
+    }
+    m_buffer.append(data, size);
+
+    if (pendingBytes() > MAX_PENDING_BYTES) {
+        discard(pendingBytes() - MAX_PENDING_BYTES);
+    }
+}
+
+bool ModbusRtuFrameParser::nextFrame(QByteArray &frame, bool atFrameGap)
+{
+    // 最小帧：从站地址 + 功能码 + CRC
+    while (pendingBytes() >= 4) {
+        const char *p = m_buffer.constData() + m_head;
+        const qsizetype available = pendingBytes();
+        const quint8 address = static_cast<quint8>(p[0]);
+        const quint8 functionCode = static_cast<quint8>(p[1]);
+
+        // 保留地址（248..255）和请求中不可能出现的功能码（0、异常应答位）必为噪声
+        const bool knownCustomCode = functionCode == ReadFile || functionCode == WriteFile
+                || functionCode == FileTransfer;
+        if (address > 247 || functionCode == 0 || (functionCode & 0x80 && !knownCustomCode)) {
+            discard(1);
+            continue;
+        }
+
+        const int length = ModbusRtuPort::getExpectedFrameLength(functionCode, p, available);
+
+        // 其他从站的帧：整帧丢弃，不做 CRC 和解码；不能只跳过地址字节，
+        // 否则帧内数据会被当作帧起点重新扫描（如 00 06 ... 被误认为广播写）
+        if (m_filter && !m_filter->accepts(address)) {
+            if (length > 4 && length <= ModbusConst::MAX_RTU_ADU_SIZE && available >= length) {
+                filter(length);
+                continue;
+            }
+            // 帧长不确定或帧未收完：等到静默期，之前的字节都属于这一帧
+            if (!atFrameGap) {
+                return false;
+            }
+            filter(available);
+            return false;
+        }
+
+        if (length > ModbusConst::MAX_RTU_ADU_SIZE) {
+            discard(1);  // 噪声字节解析出的长度越界
+            continue;
+        }
+
+        if (length >= 0 && available >= length) {
+            if (isValidFrame(m_head, length)) {
+                takeFrame(frame, length);
+                return true;
+            }
+            // 长度规则对未知功能码只给出最小长度 4，帧尾只能由静默期确定；
+            // 其余情况 CRC 错误说明当前位置不是帧起点，向后滑动一个字节
+            if (length != 4) {
+                discard(1);
+                continue;
+            }
+        }
+
+        if (!atFrameGap) {
+            return false;  // 帧未收完，等待后续字节或静默期
+        }
+
+        // 静默期后不会再有字节：整段能通过 CRC 就是一帧
+        if (available <= ModbusConst::MAX_RTU_ADU_SIZE && isValidFrame(m_head, available)) {
+            takeFrame(frame, available);
+            return true;
+        }
+        discard(1);
+    }
+
+    // 静默期后不足一帧的残余字节不可能再成帧
+    if (atFrameGap && pendingBytes() > 0) {
+        discard(pendingBytes());
+    }
+    return false;
+}
+
+void ModbusRtuFrameParser::clear()
+{
+    m_buffer.clear();
+    m_head = 0;
+}
+
+bool ModbusRtuFrameParser::isValidFrame(qsizetype offset, qsizetype length) const
+{
+    const char *p = m_buffer.constData() + offset;
+    quint16 receivedCrc = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(p + length - 2));
+    return ModbusRtuPort::calculateCRC(p, length - 2) == receivedCrc;
+}
+
+void ModbusRtuFrameParser::takeFrame(QByteArray &frame, qsizetype length)
+{
+    frame = QByteArray::fromRawData(m_buffer.constData() + m_head, length);
+    m_head += length;
+    m_frameCount++;
+}
+
+void ModbusRtuFrameParser::discard(qsizetype count)
+{
+    m_head += count;
+    m_discardedBytes += count;
+}
+
+void ModbusRtuFrameParser::filter(qsizetype count)
+{
+    m_head += count;
+    m_filteredBytes += count;
+}
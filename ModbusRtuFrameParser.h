@@ -0,0 +1,73 @@
+/**
+ * @file ModbusRtuFrameParser.h
+ * @brief Modbus RTU 流式帧解析器头文件
+ *
+ * 不假设缓冲区从帧边界开始：按功能码的长度规则推断帧长，以 CRC 确认边界，
+ * 校验失败时逐字节滑动重同步；一次读取中的多个连续帧逐个取出
+ */
+
+#ifndef MODBUSRTUFRAMEPARSER_H
+#define MODBUSRTUFRAMEPARSER_H
+
+#include <QByteArray>
+#include <QList>
+#include <atomic>
+
+// 本站响应的 RTU 从站地址集合（256 位位图，可在运行中由其他线程修改）
+class RtuAddressFilter
+{
+public:
+    RtuAddressFilter() { setAddresses(QList<int>()); }
+
+    // 空列表表示响应所有地址；广播地址 0 不受过滤影响
+    void setAddresses(const QList<int> &addresses);
+    bool accepts(quint8 address) const
+    {
+        return address == 0
+            || (m_bits[address >> 6].load(std::memory_order_relaxed) >> (address & 63)) & 1;
+    }
+
+private:
+    std::atomic<quint64> m_bits[4];
+};
+
+// Modbus RTU 流式帧解析器（非线程安全，由所属链路线程独占使用）
+class ModbusRtuFrameParser
+{
+public:
+    ModbusRtuFrameParser() = default;
+
+    // 发给其他从站的帧在 CRC 校验之前整帧丢弃（多站总线）
+    void setAddressFilter(const RtuAddressFilter *filter) { m_filter = filter; }
+
+    // 追加接收到的字节
+    void append(const char *data, qsizetype size);
+    void append(const QByteArray &data) { append(data.constData(), data.size()); }
+
+    // 取出下一个完整帧，返回 false 表示需要更多数据
+    // atFrameGap 为 true 表示已经过 t3.5 静默期：剩余数据不会再有后续字节，
+    // 长度规则无法确定的帧按整段 CRC 判断，仍不能成帧的数据作为噪声丢弃
+    // frame 直接引用内部缓冲区，在下一次 append() 之前有效
+    bool nextFrame(QByteArray &frame, bool atFrameGap = false);
+
+    qsizetype pendingBytes() const { return m_buffer.size() - m_head; }
+    quint64 frameCount() const { return m_frameCount; }
+    quint64 discardedBytes() const { return m_discardedBytes; }
+    quint64 filteredBytes() const { return m_filteredBytes; }
+    void clear();
+
+private:
+    bool isValidFrame(qsizetype offset, qsizetype length) const;
+    void takeFrame(QByteArray &frame, qsizetype length);
+    void discard(qsizetype count);
+    void filter(qsizetype count);   // 丢弃其他从站的帧
+
+    QByteArray m_buffer;
+    qsizetype m_head = 0;           // 尚未解析数据的起始位置
+    const RtuAddressFilter *m_filter = nullptr;
+    quint64 m_frameCount = 0;
+    quint64 m_discardedBytes = 0;   // 噪声
+    quint64 m_filteredBytes = 0;    // 其他从站的数据
+};
+
+#endif // MODBUSRTUFRAMEPARSER_H
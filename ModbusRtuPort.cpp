@@ -0,0 +1,390 @@
+/**
+ * @file ModbusRtuPort.cpp
+ * @brief Modbus RTU 串口链路实现
+ */
+
+#include "ModbusRtuPort.h"
+#include "ModbusTypes.h"
+#include "ModbusCrc.h"
+#include <QDebug>
+
+#ifdef Q_OS_UNIX
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <ctime>
+#endif
+
+ModbusRtuPort::ModbusRtuPort(const QString &portName, int baudRate, RequestHandler handler,
+                             QObject *parent)
+    : QObject(parent)
+    , m_portName(portName)
+    , m_baudRate(baudRate)
+    , m_handler(std::move(handler))
+    , m_serialPort(nullptr)
+    , m_frameTimer(nullptr)
+    , m_frameGapUs(frameGapUs(baudRate))
+    , m_lastByteUs(0)
+    , m_stopRequested(false)
+{
+    m_wakePipe[0] = -1;
+    m_wakePipe[1] = -1;
+}
+
+ModbusRtuPort::~ModbusRtuPort()
+{
+    close();
+}
+
+QString ModbusRtuPort::open()
+{
+    m_serialPort = new QSerialPort(this);
+    m_serialPort->setPortName(m_portName);
+    m_serialPort->setBaudRate(m_baudRate);
+    m_serialPort->setDataBits(QSerialPort::Data8);
+    m_serialPort->setParity(QSerialPort::NoParity);
+    m_serialPort->setStopBits(QSerialPort::OneStop);
+    m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
+
+    if (!m_serialPort->open(QIODevice::ReadWrite)) {
+        QString error = m_serialPort->errorString();
+        delete m_serialPort;
+        m_serialPort = nullptr;
+        return error;
+    }
+
+    connect(m_serialPort, &QSerialPort::errorOccurred, this, &ModbusRtuPort::onError);
+
+    m_stopRequested = false;
+    m_clock.start();
+    m_parser.clear();
+
+#ifdef Q_OS_UNIX
+    // 接收循环独占链路线程，通过管道唤醒以便退出
+    if (::pipe(m_wakePipe) != 0) {
+        QString error = QString::fromLocal8Bit(strerror(errno));
+        m_serialPort->close();
+        delete m_serialPort;
+        m_serialPort = nullptr;
+        return error;
+    }
+    ::fcntl(m_wakePipe[0], F_SETFL, O_NONBLOCK);
+    ::fcntl(m_wakePipe[1], F_SETFL, O_NONBLOCK);
+
+    qDebug() << "RTU 帧间隔 t3.5 =" << m_frameGapUs << "us (波特率:" << m_baudRate << ")";
+    QMetaObject::invokeMethod(this, [this]() { runReceiveLoop(); }, Qt::QueuedConnection);
+#else
+    // 精确定时器只有毫秒粒度，向上取整
+    connect(m_serialPort, &QSerialPort::readyRead, this, &ModbusRtuPort::onReadyRead);
+    m_frameTimer = new QTimer(this);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    m_frameTimer->setInterval(int((m_frameGapUs + 999) / 1000));
+    m_frameTimer->setSingleShot(true);
+    qDebug() << "RTU 帧间隔 t3.5 =" << m_frameTimer->interval() << "ms (波特率:" << m_baudRate << ")";
+    connect(m_frameTimer, &QTimer::timeout, this, &ModbusRtuPort::onFrameTimeout);
+#endif
+
+    return QString();
+}
+
+void ModbusRtuPort::requestStop()
+{
+    m_stopRequested = true;
+#ifdef Q_OS_UNIX
+    if (m_wakePipe[1] >= 0) {
+        char wake = 0;
+        [[maybe_unused]] ssize_t n = ::write(m_wakePipe[1], &wake, 1);
+    }
+#endif
+}
+
+void ModbusRtuPort::close()
+{
+    if (m_frameTimer) {
+        m_frameTimer->stop();
+        delete m_frameTimer;
+        m_frameTimer = nullptr;
+    }
+
+    if (m_serialPort) {
+        m_serialPort->close();
+        delete m_serialPort;
+        m_serialPort = nullptr;
+    }
+
+#ifdef Q_OS_UNIX
+    for (int &fd : m_wakePipe) {
+        if (fd >= 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+#endif
+
+    m_parser.clear();
+}
+
+void ModbusRtuPort::onReadyRead()
+{
+    if (!m_serialPort) return;
+
+    // 读取串口数据，已完整的帧立即处理
+    m_parser.append(m_serialPort->readAll());
+    drainFrames(false);
+    
+    // 还有未成帧的数据，重启定时器等待更多数据或静默期
+    if (m_parser.pendingBytes() > 0) {
+        m_frameTimer->start();
+    } else {
+        m_frameTimer->stop();
+    }
+}
+
+void ModbusRtuPort::onFrameTimeout()
+{
+    if (m_parser.pendingBytes() > 0) {
+        qDebug() << "⏱ 帧间隔到期，处理缓冲区数据，长度:" << m_parser.pendingBytes();
+        drainFrames(true);
+    }
+}
+
+void ModbusRtuPort::drainFrames(bool atFrameGap)
+{
+    // 一次读取中可能包含多个连续帧，逐个取出处理；噪声只影响被破坏的那一帧
+    const quint64 discardedBefore = m_parser.discardedBytes();
+    QByteArray frame;
+    while (m_parser.nextFrame(frame, atFrameGap)) {
+        processFrame(frame);
+    }
+
+    if (m_parser.discardedBytes() != discardedBefore) {
+        qDebug() << "RTU 重同步 (" << m_portName << ")，丢弃"
+                 << (m_parser.discardedBytes() - discardedBefore) << "字节";
+    }
+}
+
+void ModbusRtuPort::processFrame(const QByteArray &frame)
+{
+    QByteArray response = m_handler(frame);
+    if (!response.isEmpty() && m_serialPort) {
+        writeFrame(response);
+    }
+}
+
+void ModbusRtuPort::writeFrame(const QByteArray &frame)
+{
+#ifdef Q_OS_UNIX
+    // 接收循环占用了链路线程的事件循环，QSerialPort 的写缓冲无法刷出，直接写句柄
+    const int fd = m_serialPort->handle();
+    qsizetype written = 0;
+    while (written < frame.size()) {
+        ssize_t n = ::write(fd, frame.constData() + written, size_t(frame.size() - written));
+        if (n > 0) {
+            written += n;
+        } else if (n < 0 && errno == EINTR) {
+            continue;
+        } else if (n < 0 && errno == EAGAIN) {
+            pollfd pfd = { fd, POLLOUT, 0 };
+            if (::poll(&pfd, 1, 100) <= 0) {
+                break;
+            }
+        } else {
+            break;
+        }
+    }
+    if (written < frame.size()) {
+        qWarning() << "RTU 应答发送不完整 (" << m_portName << "):" << written << "/" << frame.size();
+    }
+#else
+    m_serialPort->write(frame);
+#endif
+}
+
+#ifdef Q_OS_UNIX
+
+void ModbusRtuPort::runReceiveLoop()
+{
+    if (!m_serialPort) {
+        return;
+    }
+
+    const int fd = m_serialPort->handle();
+    char chunk[512];
+
+    // 循环启动前事件循环可能已经读走了一部分数据
+    m_parser.append(m_serialPort->readAll());
+    m_lastByteUs = nowUs();
+
+    while (!m_stopRequested) {
+        // 缓冲区为空时一直等待；有数据时只等到最后一个字节之后 t3.5
+        qint64 waitUs = -1;
+        if (m_parser.pendingBytes() > 0) {
+            waitUs = m_lastByteUs + m_frameGapUs - nowUs();
+            if (waitUs <= 0) {
+                drainFrames(true);
+                continue;
+            }
+        }
+
+        pollfd fds[2] = { { fd, POLLIN, 0 }, { m_wakePipe[0], POLLIN, 0 } };
+#ifdef Q_OS_LINUX
+        timespec timeout = { time_t(waitUs / 1000000), long(waitUs % 1000000) * 1000 };
+        int ready = ::ppoll(fds, 2, waitUs < 0 ? nullptr : &timeout, nullptr);
+#else
+        int ready = ::poll(fds, 2, waitUs < 0 ? -1 : int((waitUs + 999) / 1000));
+#endif
+        if (ready < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            emit errorOccurred(QString("RTU 错误 (%1): %2").arg(m_portName, QString::fromLocal8Bit(strerror(errno))));
+            break;
+        }
+        if (ready == 0) {
+            continue;  // 帧间隔到期，下一轮处理
+        }
+
+        if (fds[0].revents & (POLLERR | POLLHUP | POLLNVAL)) {
+            emit errorOccurred(QString("RTU 错误 (%1): 串口已断开").arg(m_portName));
+            break;
+        }
+
+        if (fds[0].revents & POLLIN) {
+            ssize_t n;
+            while ((n = ::read(fd, chunk, sizeof(chunk))) > 0 || (n < 0 && errno == EINTR)) {
+                if (n > 0) {
+                    m_parser.append(chunk, n);
+                }
+            }
+            // 时间戳取本批最后一个字节到达的时刻（USB 转串口的延迟定时器会让字节成批到达）
+            m_lastByteUs = nowUs();
+
+            drainFrames(false);
+        }
+    }
+
+    qDebug() << "RTU 接收循环退出:" << m_portName;
+}
+
+#endif // Q_OS_UNIX
+
+void ModbusRtuPort::onError(QSerialPort::SerialPortError error)
+{
+    if (error != QSerialPort::NoError && m_serialPort) {
+        emit errorOccurred(QString("RTU 错误 (%1): %2").arg(m_portName, m_serialPort->errorString()));
+    }
+}
+
+// ========== RTU 帧工具 ==========
+
+qint64 ModbusRtuPort::frameGapUs(int baudRate)
+{
+    // 1 字符 = 11 位；规范规定 19200 以上 t3.5 固定为 1750us
+    if (baudRate > 19200) {
+        return 1750;
+    }
+    return (35LL * 11 * 1000000) / (10LL * qMax(1, baudRate));
+}
+
+quint16 ModbusRtuPort::calculateCRC(const QByteArray &data)
+{
+    return ModbusCrc::compute(data.constData(), data.size());
+}
+
+quint16 ModbusRtuPort::calculateCRC(const char *data, qsizetype size)
+{
+    return ModbusCrc::compute(data, size);
+}
+
+int ModbusRtuPort::getExpectedFrameLength(quint8 functionCode, const QByteArray &buffer)
+{
+    return getExpectedFrameLength(functionCode, buffer.constData(), buffer.size());
+}
+
+int ModbusRtuPort::getExpectedFrameLength(quint8 functionCode, const char *data, qsizetype size)
+{
+    // RTU帧结构：从站地址(1) + 功能码(1) + 数据(N) + CRC(2)
+    int minLength = 4;  // 最小长度
+    
+    if (size < 3) {
+        return -1;  // 数据不足，无法判断
+    }
+    
+    switch (functionCode) {
+    case ReadCoils:           // 0x01
+    case ReadDiscreteInputs:  // 0x02
+    case ReadHoldingRegisters:// 0x03
+    case ReadInputRegisters:  // 0x04
+        // 读请求：从站地址 + 功能码 + 起始地址(2) + 数量(2) + CRC(2) = 8字节
+        return 8;
+        
+    case WriteSingleCoil:     // 0x05
+    case WriteSingleRegister: // 0x06
+        // 写单个：从站地址 + 功能码 + 地址(2) + 值(2) + CRC(2) = 8字节
+        return 8;
+        
+    case WriteMultipleCoils:  // 0x0F
+    case WriteMultipleRegisters: // 0x10
+        if (size >= 7) {
+            quint8 byteCount = static_cast<quint8>(data[6]);
+            // 从站地址 + 功能码 + 起始地址(2) + 数量(2) + 字节数(1) + 数据(N) + CRC(2)
+            return 7 + byteCount + 2;
+        }
+        return -1;
+        
+    case ReadFileRecord:  // 0x14 (20)
+        if (size >= 3) {
+            quint8 byteCount = static_cast<quint8>(data[2]);
+            // 从站地址 + 功能码 + 字节数(1) + 数据(N) + CRC(2)
+            return 3 + byteCount + 2;
+        }
+        return -1;
+        
+    case WriteFileRecord: // 0x15 (21)
+        if (size >= 3) {
+            quint8 byteCount = static_cast<quint8>(data[2]);
+            // 从站地址 + 功能码 + 字节数(1) + 数据(N) + CRC(2)
+            return 3 + byteCount + 2;
+        }
+        return -1;
+        
+    case ReadFile:    // 0xCB (203)
+        // 自定义读：从站地址 + 功能码 + 起始地址(2) + 数量(2) + CRC(2) = 8字节
+        return 8;
+
+    case WriteFile:   // 0xCC (204)
+        // 自定义写（同 0x10 布局）：从站地址 + 功能码 + 起始地址(2) + 数量(2) + 字节数(1) + 数据(N) + CRC(2)
+        if (size >= 7) {
+            quint8 byteCount = static_cast<quint8>(data[6]);
+            return 7 + byteCount + 2;
+        }
+        return -1;
+
+    case FileTransfer: // 0xCD (205)
+        // 从站地址 + 功能码 + 子命令 + 参数 + CRC(2)，数据块在序号之后带字节数
+        if (size < 3) {
+            return -1;
+        }
+        switch (static_cast<quint8>(data[2])) {
+        case TransferOpen:
+        case TransferCommit:
+            return 3 + 6 + 2;
+        case TransferStatus:
+        case TransferAbort:
+            return 3 + 2 + 2;
+        case TransferData:
+            if (size >= 10) {
+                return 10 + static_cast<quint8>(data[9]) + 2;
+            }
+            return -1;
+        default:
+            return minLength;
+        }
+        
+    default:
+        // 未知功能码，返回最小长度
+        return minLength;
+    }
+}
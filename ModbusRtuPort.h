@@ -0,0 +1,92 @@
+/**
+ * @file ModbusRtuPort.h
+ * @brief Modbus RTU 串口链路头文件
+ *
+ * 每个串口一个实例，运行在独立的 I/O 线程中，负责帧接收、超时判断和应答发送，
+ * 请求处理通过回调交给服务器（共享同一个数据存储）
+ *
+ * Unix 下链路线程直接轮询串口句柄，以微秒时间戳判断 t3.5 帧间隔；
+ * 其他平台使用精确定时器，粒度为 1ms
+ */
+
+#ifndef MODBUSRTUPORT_H
+#define MODBUSRTUPORT_H
+
+#include <QObject>
+#include <QSerialPort>
+#include <QTimer>
+#include <QElapsedTimer>
+#include "ModbusRtuFrameParser.h"
+#include <atomic>
+#include <functional>
+
+// Modbus RTU 串口链路
+class ModbusRtuPort : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 请求处理回调：输入完整RTU帧，返回应答帧（空表示不应答），需线程安全
+    using RequestHandler = std::function<QByteArray(const QByteArray &adu)>;
+
+    ModbusRtuPort(const QString &portName, int baudRate, RequestHandler handler,
+                  QObject *parent = nullptr);
+    ~ModbusRtuPort();
+
+    QString portName() const { return m_portName; }
+    int baudRate() const { return m_baudRate; }
+
+    // RTU 帧工具（线程安全）
+    static quint16 calculateCRC(const QByteArray &data);
+    static quint16 calculateCRC(const char *data, qsizetype size);  // 直接校验帧的一部分，无需拷贝
+    // 推断帧长最多需要帧头前 FRAME_LENGTH_HEADER_BYTES 字节（0xCD 数据块的字节数在偏移 9）
+    static constexpr int FRAME_LENGTH_HEADER_BYTES = 10;
+    static int getExpectedFrameLength(quint8 functionCode, const QByteArray &buffer);
+    static int getExpectedFrameLength(quint8 functionCode, const char *data, qsizetype size);
+    static qint64 frameGapUs(int baudRate);  // t3.5 帧间隔（微秒）
+
+    // 需在移入链路线程之前设置；过滤器本身可在运行中修改
+    void setAddressFilter(const RtuAddressFilter *filter) { m_parser.setAddressFilter(filter); }
+
+    // 线程安全：通知接收循环退出，需在 close() 之前调用
+    void requestStop();
+
+public slots:
+    // 以下槽需在链路所在线程中调用（BlockingQueuedConnection）
+    QString open();   // 返回错误信息，空字符串表示成功
+    void close();
+
+signals:
+    void errorOccurred(const QString &error);
+
+private slots:
+    void onReadyRead();
+    void onFrameTimeout();
+    void onError(QSerialPort::SerialPortError error);
+
+private:
+    void drainFrames(bool atFrameGap);
+    void processFrame(const QByteArray &frame);
+    void writeFrame(const QByteArray &frame);
+#ifdef Q_OS_UNIX
+    void runReceiveLoop();
+    qint64 nowUs() const { return m_clock.nsecsElapsed() / 1000; }
+#endif
+
+    QString m_portName;
+    int m_baudRate;
+    RequestHandler m_handler;
+
+    QSerialPort *m_serialPort;
+    QTimer *m_frameTimer;
+    ModbusRtuFrameParser m_parser;
+
+    // 帧间隔判断
+    qint64 m_frameGapUs;
+    QElapsedTimer m_clock;
+    qint64 m_lastByteUs;
+    std::atomic<bool> m_stopRequested;
+    int m_wakePipe[2];      // 唤醒接收循环的管道（读端, 写端）
+};
+
+#endif // MODBUSRTUPORT_H
@@ -6,14 +6,30 @@
  */
 
 #include "ModbusServer.h"
+#include "HexDumpFormatter.h"
+#include <QThread>
 #include <QtEndian>
 #include <QDebug>
 
 ModbusServer::ModbusServer(QObject *parent)
     : QObject(parent)
     , m_tcpServer(nullptr)
-    , m_serialPort(nullptr)
-    , m_rtuTimer(nullptr)
+    , m_tcpPort(0)
+    , m_rtuOverTcpServer(nullptr)
+    , m_rtuOverTcpPort(0)
+    , m_tcpIdleTimer(nullptr)
+    , m_maxTcpConnections(ModbusConst::TCP_MAX_CONNECTIONS)
+    , m_tcpIdleTimeoutMs(ModbusConst::TCP_IDLE_TIMEOUT_MS)
+    , m_queuedBytes(0)
+    , m_maxEventLoopLagMs(ModbusConst::ADMISSION_MAX_LAG_MS)
+    , m_maxQueuedBytes(ModbusConst::ADMISSION_MAX_QUEUED_BYTES)
+    , m_clientQuotaRate(ModbusConst::CLIENT_QUOTA_RATE)
+    , m_clientQuotaBurst(ModbusConst::CLIENT_QUOTA_BURST)
+    , m_shedCount(0)
+    , m_framesPerTurn(ModbusConst::SCHEDULER_FRAMES_PER_TURN)
+    , m_prioritizeWrites(true)
+    , m_serveTurnPending(false)
+    , m_udpTransport(nullptr)
     , m_running(false)
     , m_mode(ModeTCP)
     , m_requestCount(0)
@@ -24,6 +40,14 @@ ModbusServer::ModbusServer(QObject *parent)
     m_functionHandler = new ModbusFunctionHandler(m_dataStore, this);
     m_fileStore = new FileStore(this);
     m_addressStore = new FileAddressStore(this);
+    m_fileTransfer = new FileTransferService(m_fileStore, this);
+    m_lagMonitor = new EventLoopLagMonitor(this);
+    m_clock.start();
+
+    // 定期回收空闲连接，防止半开连接长期占用名额（TCP 与 RTU over TCP 共用）
+    m_tcpIdleTimer = new QTimer(this);
+    m_tcpIdleTimer->setInterval(1000);
+    connect(m_tcpIdleTimer, &QTimer::timeout, this, &ModbusServer::onTcpIdleCheck);
 
     // 连接信号
     connect(m_functionHandler, &ModbusFunctionHandler::requestProcessed,
@@ -31,6 +55,18 @@ ModbusServer::ModbusServer(QObject *parent)
         incrementRequestCount();
         emit requestReceived(fc);
     });
+    connect(m_fileTransfer, &FileTransferService::transferStarted,
+            this, [this](quint16 sessionId, quint16 startFile, quint32 totalSize) {
+        setStatusMessage(QString("文件传输会话 %1 开始: 文件 %2 起 %3 字节")
+                         .arg(sessionId).arg(startFile).arg(totalSize));
+    });
+    connect(m_fileTransfer, &FileTransferService::transferFinished,
+            this, [this](quint16 sessionId, bool success, const QString &message) {
+        setStatusMessage(QString("会话 %1: %2").arg(sessionId).arg(message));
+        if (!success) {
+            emit errorOccurred(m_statusMessage);
+        }
+    });
 }
 
 ModbusServer::~ModbusServer()
@@ -42,8 +78,9 @@ ModbusServer::~ModbusServer()
 
 bool ModbusServer::startTcp(quint16 port)
 {
-    if (m_running) {
-        stop();
+    // TCP 与 RTU 可同时运行，这里只重启 TCP 监听
+    if (m_tcpServer) {
+        stopTcp();
     }
 
     m_tcpServer = new QTcpServer(this);
@@ -57,15 +94,10 @@ bool ModbusServer::startTcp(quint16 port)
         return false;
     }
 
-    m_running = true;
-    m_mode = ModeTCP;
-    m_requestCount = 0;
-    setStatusMessage(QString("TCP 服务器运行中 (端口 %1)").arg(port));
-    
-    emit runningChanged(true);
-    emit modeChanged(m_mode);
-    emit requestCountChanged(m_requestCount);
-    
+    m_shedCount = 0;
+    m_tcpPort = port;
+    updateLoadMonitors();
+    transportStarted(ModeTCP, QString("TCP 服务器运行中 (端口 %1)").arg(port));
     return true;
 }
 
@@ -73,59 +105,328 @@ void ModbusServer::stopTcp()
 {
     if (m_tcpServer) {
         m_tcpServer->close();
-        
-        for (QTcpSocket *socket : m_tcpClients) {
-            socket->disconnectFromHost();
-            socket->deleteLater();
-        }
-        m_tcpClients.clear();
-        m_tcpBuffers.clear();
-        
+        closeTcpConnections(TcpConnection::FramingMbap);
+
         delete m_tcpServer;
         m_tcpServer = nullptr;
+        updateLoadMonitors();
+        updateRunningState();
+    }
+}
+
+// ========== RTU over TCP 服务器 ==========
+
+bool ModbusServer::startRtuOverTcp(quint16 port)
+{
+    // 与 TCP 监听共用连接表、调度和准入控制，只是帧格式不同
+    stopRtuOverTcp();
+
+    m_rtuOverTcpServer = new QTcpServer(this);
+    connect(m_rtuOverTcpServer, &QTcpServer::newConnection, this, &ModbusServer::onNewTcpConnection);
+
+    if (!m_rtuOverTcpServer->listen(QHostAddress::Any, port)) {
+        setStatusMessage(QString("RTU over TCP 启动失败: %1").arg(m_rtuOverTcpServer->errorString()));
+        emit errorOccurred(m_statusMessage);
+        delete m_rtuOverTcpServer;
+        m_rtuOverTcpServer = nullptr;
+        return false;
+    }
+
+    m_rtuOverTcpPort = m_rtuOverTcpServer->serverPort();  // port 为 0 时由系统分配
+    updateLoadMonitors();
+    transportStarted(ModeRtuOverTcp, QString("RTU over TCP 服务器运行中 (端口 %1)").arg(m_rtuOverTcpPort));
+    return true;
+}
+
+void ModbusServer::stopRtuOverTcp()
+{
+    if (m_rtuOverTcpServer) {
+        m_rtuOverTcpServer->close();
+        closeTcpConnections(TcpConnection::FramingRtu);
+
+        delete m_rtuOverTcpServer;
+        m_rtuOverTcpServer = nullptr;
+        updateLoadMonitors();
+        updateRunningState();
     }
 }
 
+// ========== TCP 连接处理 ==========
+
 void ModbusServer::onNewTcpConnection()
 {
-    while (m_tcpServer->hasPendingConnections()) {
-        QTcpSocket *socket = m_tcpServer->nextPendingConnection();
-        m_tcpClients.append(socket);
-        m_tcpBuffers[socket] = QByteArray();
+    QTcpServer *server = qobject_cast<QTcpServer*>(sender());
+    if (!server) return;
+
+    const TcpConnection::Framing framing = (server == m_rtuOverTcpServer)
+            ? TcpConnection::FramingRtu : TcpConnection::FramingMbap;
+
+    while (server->hasPendingConnections()) {
+        QTcpSocket *socket = server->nextPendingConnection();
+
+        // 全局连接数上限：超出时直接拒绝新连接，保护已有主站
+        if (m_tcpConnections.size() >= m_maxTcpConnections) {
+            qWarning() << "TCP 连接数已达上限" << m_maxTcpConnections
+                       << "，拒绝连接:" << socket->peerAddress().toString();
+            socket->abort();
+            socket->deleteLater();
+            continue;
+        }
+
+        // 限制 Qt 内部读缓冲，超出部分留在内核中，由 TCP 流控反压客户端
+        socket->setReadBufferSize(ModbusConst::TCP_RX_BUFFER_SIZE);
+
+        TcpConnection *conn = new TcpConnection(socket, framing);
+        conn->lastActivityMs = m_clock.elapsed();
+        conn->quota.configure(m_clientQuotaRate, m_clientQuotaBurst);
+        m_tcpConnections.insert(socket, conn);
 
         connect(socket, &QTcpSocket::readyRead, this, &ModbusServer::onTcpReadyRead);
         connect(socket, &QTcpSocket::disconnected, this, &ModbusServer::onTcpDisconnected);
+        // 连接状态随套接字一起释放，处理过程中即使断开也不会悬空
+        connect(socket, &QObject::destroyed, [conn]() { delete conn; });
     }
 }
 
 void ModbusServer::onTcpReadyRead()
 {
     QTcpSocket *socket = qobject_cast<QTcpSocket*>(sender());
-    if (!socket) return;
+    TcpConnection *conn = m_tcpConnections.value(socket);
+    if (!conn) return;
+
+    // 这里只接收数据并登记到调度队列，真正的处理在 onServeTurn 中轮转进行
+    readTcpConnection(conn);
+    enqueueTcpConnection(conn);
+}
+
+// 检查 offset 处是否为合法的 MBAP 头：协议ID为0，长度覆盖单元ID + 1..253字节PDU
+static bool isValidMbapHeader(const ModbusRingBuffer &buffer, qsizetype offset)
+{
+    quint16 protocolId = buffer.peekUInt16BE(offset + 2);
+    quint16 length = buffer.peekUInt16BE(offset + 4);
+    return protocolId == 0 && length >= 2 && length <= ModbusConst::MAX_PDU_SIZE + 1;
+}
+
+// 写类功能码（优先调度）
+static bool isWriteFunctionCode(quint8 functionCode)
+{
+    switch (functionCode) {
+    case WriteSingleCoil:
+    case WriteSingleRegister:
+    case WriteMultipleCoils:
+    case WriteMultipleRegisters:
+    case WriteFileRecord:
+    case WriteFile:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void ModbusServer::readTcpConnection(TcpConnection *conn)
+{
+    qsizetype received = conn->rxBuffer.readFrom(conn->socket);
+    if (received > 0) {
+        conn->lastActivityMs = m_clock.elapsed();
+        m_queuedBytes += received;
+    }
+}
+
+int ModbusServer::nextTcpFrameLength(TcpConnection *conn)
+{
+    if (conn->framing == TcpConnection::FramingRtu) {
+        return nextRtuFrameLength(conn);
+    }
+
+    ModbusRingBuffer &buffer = conn->rxBuffer;
+
+    while (!conn->closing && buffer.size() >= 8) {  // MBAP 头 (7 字节) + 至少 1 字节 PDU
+        // 非法头部（协议ID非0或长度越界）：重同步，超出预算则断开
+        if (!isValidMbapHeader(buffer, 0)) {
+            if (!resyncTcpStream(conn)) {
+                return 0;
+            }
+            continue;
+        }
+
+        // 读取长度字段：MBAP 头前 6 字节 + 长度
+        int totalLength = 6 + buffer.peekUInt16BE(4);
+        return buffer.size() >= totalLength ? totalLength : 0;
+    }
+
+    return 0;
+}
+
+int ModbusServer::nextRtuFrameLength(TcpConnection *conn)
+{
+    if (conn->verifiedLength > 0) {
+        return conn->verifiedLength;
+    }
+
+    ModbusRingBuffer &buffer = conn->rxBuffer;
+
+    while (!conn->closing && buffer.size() >= 4) {  // 从站地址 + 功能码 + CRC
+        // 沿用串口链路的帧长推断，只需要帧头前几个字节
+        QByteArray header(qMin<qsizetype>(buffer.size(), ModbusRtuPort::FRAME_LENGTH_HEADER_BYTES),
+                          Qt::Uninitialized);
+        for (int i = 0; i < header.size(); ++i) {
+            header[i] = static_cast<char>(buffer.at(i));
+        }
+        int frameLength = ModbusRtuPort::getExpectedFrameLength(static_cast<quint8>(header.at(1)), header);
+        if (frameLength < 0) {
+            return 0;  // 帧头不完整，等待更多数据
+        }
+
+        if (frameLength <= ModbusConst::MAX_RTU_ADU_SIZE) {
+            if (buffer.size() < frameLength) {
+                return 0;
+            }
 
-    QByteArray &buffer = m_tcpBuffers[socket];
-    buffer.append(socket->readAll());
+            // 字节流中没有帧间隔可用，以 CRC 判定帧边界
+            QByteArray frame = buffer.frameView(frameLength, conn->scratch);
+            quint16 receivedCrc = qFromLittleEndian<quint16>(
+                        reinterpret_cast<const uchar*>(frame.constData() + frameLength - 2));
+            if (ModbusRtuPort::calculateCRC(frame.constData(), frameLength - 2) == receivedCrc) {
+                conn->verifiedLength = frameLength;
+                return frameLength;
+            }
+        }
+
+        // 长度越界或 CRC 错误：逐字节滑动重同步，超出预算则断开
+        if (!resyncTcpStream(conn)) {
+            return 0;
+        }
+    }
+
+    return 0;
+}
+
+bool ModbusServer::isPriorityFrame(const TcpConnection *conn) const
+{
+    // MBAP 帧单元ID在偏移 6；RTU 帧从站地址在偏移 0，其后紧跟功能码
+    const int unitOffset = (conn->framing == TcpConnection::FramingRtu) ? 0 : 6;
+    quint8 unitId = conn->rxBuffer.at(unitOffset);
+    quint8 functionCode = conn->rxBuffer.at(unitOffset + 1);
+    return (m_prioritizeWrites && isWriteFunctionCode(functionCode))
+            || m_priorityUnitIds.contains(unitId);
+}
+
+void ModbusServer::enqueueTcpConnection(TcpConnection *conn)
+{
+    if (conn->scheduled || nextTcpFrameLength(conn) <= 0) {
+        return;
+    }
+
+    // 按队首帧分类：写请求或指定单元ID进入优先队列
+    conn->scheduled = true;
+    if (isPriorityFrame(conn)) {
+        m_priorityQueue.enqueue(conn->socket);
+    } else {
+        m_normalQueue.enqueue(conn->socket);
+    }
+
+    // 合并为一次排队调用，让 I/O 事件与处理轮次交替进行
+    if (!m_serveTurnPending) {
+        m_serveTurnPending = true;
+        QMetaObject::invokeMethod(this, &ModbusServer::onServeTurn, Qt::QueuedConnection);
+    }
+}
+
+void ModbusServer::onServeTurn()
+{
+    m_serveTurnPending = false;
+
+    // 先服务优先队列，再轮转普通队列
+    serveTcpQueue(m_priorityQueue, true);
+    serveTcpQueue(m_normalQueue, false);
+}
+
+void ModbusServer::serveTcpQueue(QQueue<QTcpSocket*> &queue, bool priorityOnly)
+{
+    // 只服务本轮开始时已排队的连接，期间重新排队的连接留到下一轮
+    int count = queue.size();
+    while (count-- > 0 && !queue.isEmpty()) {
+        TcpConnection *conn = m_tcpConnections.value(queue.dequeue());
+        if (!conn) {
+            continue;
+        }
+
+        conn->scheduled = false;
+        serveTcpConnection(conn, priorityOnly);
+
+        if (!conn->closing) {
+            readTcpConnection(conn);  // 缓冲区已腾出空间，继续读取套接字中积压的数据
+            enqueueTcpConnection(conn);
+        }
+    }
+}
 
-    // 处理所有完整的请求
-    while (buffer.size() >= 8) {  // MBAP 头 (7 字节) + 至少 1 字节 PDU
-        // 读取长度字段
-        quint16 length = qFromBigEndian<quint16>(reinterpret_cast<const uchar*>(buffer.data() + 4));
-        int totalLength = 6 + length;  // MBAP 头前 6 字节 + 长度
+void ModbusServer::serveTcpConnection(TcpConnection *conn, bool priorityOnly)
+{
+    ModbusRingBuffer &buffer = conn->rxBuffer;
 
-        if (buffer.size() < totalLength) {
+    // 每个连接每轮最多处理 m_framesPerTurn 帧，防止流水线大量请求的客户端独占事件循环
+    for (int served = 0; served < m_framesPerTurn && !conn->closing; ++served) {
+        int totalLength = nextTcpFrameLength(conn);
+        if (totalLength <= 0) {
             break;  // 等待更多数据
         }
+        if (priorityOnly && !isPriorityFrame(conn)) {
+            break;  // 剩余帧回到普通队列
+        }
 
-        // 提取完整的 ADU
-        QByteArray adu = buffer.left(totalLength);
-        buffer.remove(0, totalLength);
+        // 原地取帧视图，处理完成后再从缓冲区移除
+        // 过载或超出客户端配额时不再排队处理，立即应答设备忙
+        QByteArray adu = buffer.frameView(totalLength, conn->scratch);
+        const bool rtu = (conn->framing == TcpConnection::FramingRtu);
+        const quint8 rtuAddress = rtu ? static_cast<quint8>(adu[0]) : 0;
+        QByteArray response;
+        if (rtu && !m_rtuAddressFilter.accepts(rtuAddress)) {
+            // 发给其他从站的帧不参与准入判断，也不应答
+        } else if (admitTcpRequest(conn)) {
+            response = rtu ? processRtuRequest(adu) : processTcpRequest(adu);
+        } else if (rtu && rtuAddress == 0) {
+            // 拒绝的广播同样保持静默
+        } else {
+            response = rtu ? buildRtuExceptionResponse(adu, SlaveDeviceBusy)
+                           : buildTcpExceptionResponse(adu, SlaveDeviceBusy);
+        }
+        buffer.consume(totalLength);
+        m_queuedBytes -= totalLength;
+        conn->verifiedLength = 0;
+        conn->discardedBytes = 0;  // 已重新同步，限额只约束一次连续的重同步
 
-        // 处理请求
-        QByteArray response = processTcpRequest(adu);
         if (!response.isEmpty()) {
-            socket->write(response);
+            conn->socket->write(response);
+        }
+    }
+}
+
+bool ModbusServer::resyncTcpStream(TcpConnection *conn)
+{
+    ModbusRingBuffer &buffer = conn->rxBuffer;
+
+    // 跳过当前字节；MBAP 帧继续向后查找下一个看起来合法的头部，
+    // RTU 帧没有可识别的头部，只能逐字节尝试 CRC
+    qsizetype skip = 1;
+    if (conn->framing == TcpConnection::FramingMbap) {
+        while (skip + 6 <= buffer.size() && !isValidMbapHeader(buffer, skip)) {
+            ++skip;
         }
     }
+
+    buffer.consume(skip);
+    m_queuedBytes -= skip;
+    conn->discardedBytes += skip;
+    qWarning() << (conn->framing == TcpConnection::FramingRtu ? "RTU 帧校验失败" : "MBAP 头非法")
+               << "，丢弃" << skip << "字节重新同步:" << conn->socket->peerAddress().toString();
+
+    if (conn->discardedBytes > ModbusConst::TCP_MAX_RESYNC_BYTES) {
+        qWarning() << "客户端持续发送非法数据，断开连接:" << conn->socket->peerAddress().toString();
+        closeTcpConnection(conn);
+        return false;
+    }
+    return true;
 }
 
 void ModbusServer::onTcpDisconnected()
@@ -135,11 +436,176 @@ void ModbusServer::onTcpDisconnected()
 
     qDebug() << "客户端断开连接:" << socket->peerAddress().toString();
     
-    m_tcpClients.removeOne(socket);
-    m_tcpBuffers.remove(socket);
+    TcpConnection *conn = m_tcpConnections.take(socket);
+    m_priorityQueue.removeAll(socket);
+    m_normalQueue.removeAll(socket);
+    if (conn) {
+        conn->closing = true;
+        m_queuedBytes -= conn->rxBuffer.size();
+        conn->rxBuffer.clear();
+    }
     socket->deleteLater();
 }
 
+void ModbusServer::onTcpIdleCheck()
+{
+    if (m_tcpIdleTimeoutMs <= 0) {
+        return;
+    }
+
+    // 先收集再断开，关闭连接会修改连接表
+    const qint64 now = m_clock.elapsed();
+    QList<TcpConnection*> idleConnections;
+    for (TcpConnection *conn : std::as_const(m_tcpConnections)) {
+        if (now - conn->lastActivityMs > m_tcpIdleTimeoutMs) {
+            idleConnections.append(conn);
+        }
+    }
+
+    for (TcpConnection *conn : idleConnections) {
+        qDebug() << "回收空闲连接:" << conn->socket->peerAddress().toString();
+        closeTcpConnection(conn);
+    }
+}
+
+void ModbusServer::closeTcpConnection(TcpConnection *conn)
+{
+    // 先断开信号，避免 abort() 同步触发 onTcpDisconnected
+    conn->closing = true;
+    m_tcpConnections.remove(conn->socket);
+    m_priorityQueue.removeAll(conn->socket);
+    m_normalQueue.removeAll(conn->socket);
+    m_queuedBytes -= conn->rxBuffer.size();
+    conn->rxBuffer.clear();
+    conn->socket->disconnect(this);
+    conn->socket->abort();
+    conn->socket->deleteLater();
+}
+
+void ModbusServer::closeTcpConnections(TcpConnection::Framing framing)
+{
+    // 只关闭指定监听上的连接，另一个监听上的连接不受影响
+    for (auto it = m_tcpConnections.begin(); it != m_tcpConnections.end(); ) {
+        TcpConnection *conn = it.value();
+        if (conn->framing != framing) {
+            ++it;
+            continue;
+        }
+
+        conn->closing = true;
+        m_priorityQueue.removeAll(conn->socket);
+        m_normalQueue.removeAll(conn->socket);
+        m_queuedBytes -= conn->rxBuffer.size();
+        conn->rxBuffer.clear();
+        conn->socket->disconnect(this);
+        conn->socket->disconnectFromHost();
+        conn->socket->deleteLater();
+        it = m_tcpConnections.erase(it);
+    }
+}
+
+void ModbusServer::updateLoadMonitors()
+{
+    // 空闲回收只针对 TCP 连接；延迟监测在任一网络传输运行时都需要
+    const bool listening = m_tcpServer || m_rtuOverTcpServer;
+    if (listening && !m_tcpIdleTimer->isActive()) {
+        m_tcpIdleTimer->start();
+    } else if (!listening) {
+        m_tcpIdleTimer->stop();
+    }
+
+    const bool networked = listening || m_udpTransport;
+    if (networked && !m_lagMonitor->isActive()) {
+        m_lagMonitor->start();
+    } else if (!networked && m_lagMonitor->isActive()) {
+        m_lagMonitor->stop();
+    }
+}
+
+// ========== 请求调度 ==========
+
+void ModbusServer::setSchedulerQuantum(int framesPerTurn)
+{
+    m_framesPerTurn = qMax(1, framesPerTurn);
+}
+
+void ModbusServer::setPriorityUnitIds(const QList<int> &unitIds)
+{
+    m_priorityUnitIds.clear();
+    for (int id : unitIds) {
+        m_priorityUnitIds.insert(static_cast<quint8>(id));
+    }
+}
+
+// ========== 准入控制 ==========
+
+void ModbusServer::setAdmissionLimits(int maxEventLoopLagMs, int maxQueuedBytes)
+{
+    m_maxEventLoopLagMs = maxEventLoopLagMs;
+    m_maxQueuedBytes = maxQueuedBytes;
+}
+
+void ModbusServer::setClientQuota(double ratePerSecond, int burst)
+{
+    m_clientQuotaRate = ratePerSecond;
+    m_clientQuotaBurst = burst;
+    for (TcpConnection *conn : std::as_const(m_tcpConnections)) {
+        conn->quota.configure(ratePerSecond, burst);
+    }
+}
+
+bool ModbusServer::admitTcpRequest(TcpConnection *conn)
+{
+    bool admitted = true;
+
+    if (m_maxEventLoopLagMs > 0 && m_lagMonitor->lagMs() > m_maxEventLoopLagMs) {
+        admitted = false;  // 事件循环已积压，后续请求只会更晚得到处理
+    } else if (m_maxQueuedBytes > 0 && m_queuedBytes > m_maxQueuedBytes) {
+        admitted = false;  // 排队数据过多
+    } else if (!conn->quota.tryConsume(m_clock.elapsed())) {
+        admitted = false;  // 单个客户端请求过快
+    }
+
+    if (!admitted) {
+        m_shedCount++;
+        if ((m_shedCount & 0xFF) == 1) {  // 过载时避免日志本身加重负担
+            qWarning() << "服务器过载，已拒绝请求数:" << m_shedCount
+                       << "事件循环延迟:" << m_lagMonitor->lagMs() << "ms"
+                       << "排队字节:" << m_queuedBytes;
+        }
+    }
+    return admitted;
+}
+
+QByteArray ModbusServer::buildTcpExceptionResponse(const QByteArray &adu, quint8 exceptionCode)
+{
+    // 保留事务ID和单元ID：事务ID(2) + 协议ID(2) + 长度(2)=3 + 单元ID(1) + 异常功能码(1) + 异常码(1)
+    QByteArray responseAdu;
+    responseAdu.reserve(9);
+    responseAdu.append(adu.constData(), 2);
+    quint16 prId = qToBigEndian(quint16(0));
+    responseAdu.append(reinterpret_cast<const char*>(&prId), 2);
+    quint16 len = qToBigEndian(quint16(3));
+    responseAdu.append(reinterpret_cast<const char*>(&len), 2);
+    responseAdu.append(adu.at(6));
+    responseAdu.append(static_cast<char>(static_cast<quint8>(adu.at(7)) | 0x80));
+    responseAdu.append(static_cast<char>(exceptionCode));
+    return responseAdu;
+}
+
+QByteArray ModbusServer::buildRtuExceptionResponse(const QByteArray &adu, quint8 exceptionCode)
+{
+    // 从站地址(1) + 异常功能码(1) + 异常码(1) + CRC(2)
+    QByteArray responseAdu;
+    responseAdu.reserve(5);
+    responseAdu.append(adu.at(0));
+    responseAdu.append(static_cast<char>(static_cast<quint8>(adu.at(1)) | 0x80));
+    responseAdu.append(static_cast<char>(exceptionCode));
+    quint16 crcLe = qToLittleEndian(ModbusRtuPort::calculateCRC(responseAdu));
+    responseAdu.append(reinterpret_cast<const char*>(&crcLe), 2);
+    return responseAdu;
+}
+
 QByteArray ModbusServer::processTcpRequest(const QByteArray &adu)
 {
     if (adu.size() < 8) {
@@ -208,142 +674,147 @@ QByteArray ModbusServer::processTcpRequest(const QByteArray &adu)
     return responseAdu;
 }
 
-// ========== RTU 服务器 ==========
+// ========== UDP 服务器 ==========
 
-bool ModbusServer::startRtu(const QString &portName, int baudRate)
+bool ModbusServer::startUdp(quint16 port)
 {
-    if (m_running) {
-        stop();
-    }
+    stopUdp();
 
-    m_serialPort = new QSerialPort(this);
-    m_serialPort->setPortName(portName);
-    m_serialPort->setBaudRate(baudRate);
-    m_serialPort->setDataBits(QSerialPort::Data8);
-    m_serialPort->setParity(QSerialPort::NoParity);
-    m_serialPort->setStopBits(QSerialPort::OneStop);
-    m_serialPort->setFlowControl(QSerialPort::NoFlowControl);
+    m_udpTransport = new ModbusUdpTransport(
+        [this](const QByteArray &adu) { return processUdpRequest(adu); }, this);
 
-    if (!m_serialPort->open(QIODevice::ReadWrite)) {
-        setStatusMessage(QString("RTU 启动失败: %1").arg(m_serialPort->errorString()));
+    if (!m_udpTransport->open(port)) {
+        setStatusMessage(QString("UDP 启动失败: %1").arg(m_udpTransport->errorString()));
         emit errorOccurred(m_statusMessage);
-        delete m_serialPort;
-        m_serialPort = nullptr;
+        delete m_udpTransport;
+        m_udpTransport = nullptr;
         return false;
     }
 
-    connect(m_serialPort, &QSerialPort::readyRead, this, &ModbusServer::onRtuReadyRead);
-    connect(m_serialPort, &QSerialPort::errorOccurred, this, &ModbusServer::onRtuError);
-
-    // 创建帧间隔定时器
-    // 对于9600波特率，一个完整帧（最多256字节）传输需要约300ms
-    // 使用更保守的超时时间，确保完整帧都能接收完毕
-    m_rtuTimer = new QTimer(this);
-    int charTime = (11 * 1000) / baudRate;  // 毫秒
-    int timeout = qMax(50, charTime * 35);  // 至少50ms，或35个字符时间
-    m_rtuTimer->setInterval(timeout);
-    m_rtuTimer->setSingleShot(true);
-    qDebug() << "RTU 定时器间隔设置为:" << timeout << "ms (字符时间:" << charTime << "ms, 波特率:" << baudRate << ")";
-    connect(m_rtuTimer, &QTimer::timeout, this, [this]() {
-        if (!m_rtuBuffer.isEmpty()) {
-            qDebug() << "⏱ 定时器超时，处理缓冲区数据，长度:" << m_rtuBuffer.size();
-            QByteArray response = processRtuRequest(m_rtuBuffer);
-            if (!response.isEmpty() && m_serialPort) {
-                m_serialPort->write(response);
-            }
-            m_rtuBuffer.clear();
-        }
-    });
-
-    m_running = true;
-    m_mode = ModeRTU;
-    m_requestCount = 0;
-    setStatusMessage(QString("RTU 服务器运行中 (%1, %2)").arg(portName).arg(baudRate));
-    
-    emit runningChanged(true);
-    emit modeChanged(m_mode);
-    emit requestCountChanged(m_requestCount);
-    
+    updateLoadMonitors();
+    transportStarted(ModeUDP, QString("UDP 服务器运行中 (端口 %1)").arg(port));
     return true;
 }
 
-void ModbusServer::stopRtu()
+void ModbusServer::stopUdp()
+{
+    if (m_udpTransport) {
+        m_udpTransport->close();
+        delete m_udpTransport;
+        m_udpTransport = nullptr;
+        updateLoadMonitors();
+        updateRunningState();
+    }
+}
+
+QByteArray ModbusServer::processUdpRequest(const QByteArray &adu)
 {
-    if (m_rtuTimer) {
-        m_rtuTimer->stop();
-        delete m_rtuTimer;
-        m_rtuTimer = nullptr;
+    // UDP 无连接，不做客户端配额；事件循环积压时同样立即应答设备忙
+    if (m_maxEventLoopLagMs > 0 && m_lagMonitor->lagMs() > m_maxEventLoopLagMs) {
+        m_shedCount++;
+        return buildTcpExceptionResponse(adu, SlaveDeviceBusy);
     }
+    return processTcpRequest(adu);
+}
+
+// ========== RTU 服务器 ==========
 
-    if (m_serialPort) {
-        m_serialPort->close();
-        delete m_serialPort;
-        m_serialPort = nullptr;
+bool ModbusServer::startRtu(const QString &portName, int baudRate)
+{
+    // 同名串口已打开时重新打开，其他串口和 TCP 不受影响
+    stopRtuPort(portName);
+
+    // 每个串口一个 I/O 线程，所有链路共享同一个数据存储
+    // 请求处理只访问带锁的数据存储，可在链路线程中直接执行
+    QThread *thread = new QThread(this);
+    thread->setObjectName(QString("RTU-%1").arg(portName));
+    ModbusRtuPort *port = new ModbusRtuPort(portName, baudRate,
+        [this](const QByteArray &adu) { return processRtuRequest(adu); });
+    port->setAddressFilter(&m_rtuAddressFilter);
+    port->moveToThread(thread);
+    connect(port, &ModbusRtuPort::errorOccurred, this, &ModbusServer::onRtuError);
+    thread->start();
+
+    QString error;
+    QMetaObject::invokeMethod(port, &ModbusRtuPort::open, Qt::BlockingQueuedConnection, &error);
+
+    if (!error.isEmpty()) {
+        thread->quit();
+        thread->wait();
+        delete port;
+        delete thread;
+        setStatusMessage(QString("RTU 启动失败 (%1): %2").arg(portName, error));
+        emit errorOccurred(m_statusMessage);
+        return false;
     }
 
-    m_rtuBuffer.clear();
+    m_rtuPorts.insert(portName, RtuLink{thread, port});
+    transportStarted(ModeRTU, QString("RTU 服务器运行中 (%1, %2)").arg(portName).arg(baudRate));
+    return true;
 }
 
-void ModbusServer::onRtuReadyRead()
+void ModbusServer::stopRtuPort(const QString &portName)
 {
-    if (!m_serialPort) return;
-
-    // 读取串口数据并追加到缓冲区
-    m_rtuBuffer.append(m_serialPort->readAll());
-    
-    // 检查是否已接收到完整帧（最小4字节：从站地址 + 功能码 + CRC）
-    if (m_rtuBuffer.size() >= 4) {
-        quint8 functionCode = static_cast<quint8>(m_rtuBuffer.at(1));
-        int expectedLength = getExpectedFrameLength(functionCode, m_rtuBuffer);
-        
-        if (expectedLength > 0 && m_rtuBuffer.size() >= expectedLength) {
-            // 已接收完整帧，立即处理
-            m_rtuTimer->stop();
-            QByteArray response = processRtuRequest(m_rtuBuffer);
-            if (!response.isEmpty() && m_serialPort) {
-                m_serialPort->write(response);
-            }
-            m_rtuBuffer.clear();
-            return;
-        }
+    if (!m_rtuPorts.contains(portName)) {
+        return;
     }
-    
-    // 帧不完整，重启定时器等待更多数据
-    m_rtuTimer->start();
+
+    RtuLink link = m_rtuPorts.take(portName);
+    link.port->requestStop();  // 先让接收循环交还链路线程的事件循环
+    QMetaObject::invokeMethod(link.port, &ModbusRtuPort::close, Qt::BlockingQueuedConnection);
+    link.thread->quit();
+    link.thread->wait();
+    delete link.port;
+    delete link.thread;
+
+    updateRunningState();
 }
 
-void ModbusServer::onRtuError(QSerialPort::SerialPortError error)
+void ModbusServer::stopRtu()
 {
-    if (error != QSerialPort::NoError) {
-        setStatusMessage(QString("RTU 错误: %1").arg(m_serialPort->errorString()));
-        emit errorOccurred(m_statusMessage);
+    const QStringList portNames = m_rtuPorts.keys();
+    for (const QString &portName : portNames) {
+        stopRtuPort(portName);
     }
 }
 
+void ModbusServer::onRtuError(const QString &error)
+{
+    setStatusMessage(error);
+    emit errorOccurred(m_statusMessage);
+}
+
 QByteArray ModbusServer::processRtuRequest(const QByteArray &adu)
 {
-    emit packetReceived(formatPacket(adu, "← RTU接收"));
-    
     // 验证帧长度（最小4字节：从站地址 + 功能码 + CRC）
     if (adu.size() < 4) {
         qWarning() << "RTU请求长度不足:" << adu.size() << "字节";
         return QByteArray();
     }
 
-    // 验证CRC校验码
-    quint16 receivedCrc = qFromLittleEndian<quint16>(reinterpret_cast<const uchar*>(adu.data() + adu.size() - 2));
-    quint16 calculatedCrc = calculateCRC(adu.left(adu.size() - 2));
-    
-    if (receivedCrc != calculatedCrc) {
-        qWarning() << "RTU CRC校验失败";
+    // 多站总线上发给其他从站的帧：在 CRC 和解码之前丢弃，且不应答
+    quint8 slaveAddress = static_cast<quint8>(adu[0]);
+    if (!m_rtuAddressFilter.accepts(slaveAddress)) {
         return QByteArray();
     }
 
-    // 提取从站地址和PDU（协议数据单元）
-    quint8 slaveAddress = static_cast<quint8>(adu[0]);
+    emit packetReceived(formatPacket(adu, "← RTU接收"));
+
+    // CRC 已在成帧时校验（串口：ModbusRtuFrameParser；RTU over TCP：nextRtuFrameLength），
+    // 帧边界本身就靠 CRC 确认，这里不再重复计算
+
+    // 提取PDU（协议数据单元）
     QByteArray pdu = adu.mid(1, adu.size() - 3);
     quint8 functionCode = static_cast<quint8>(pdu[0]);
 
+    // 广播（地址 0）：只执行写操作，任何情况下都不应答，避免总线冲突
+    if (slaveAddress == 0) {
+        if (isWriteFunctionCode(functionCode)) {
+            routeFunctionCode(functionCode, pdu);
+        }
+        return QByteArray();
+    }
+
     // 路由到对应功能处理器
     QByteArray responsePdu = routeFunctionCode(functionCode, pdu);
     if (responsePdu.isEmpty()) {
@@ -356,7 +827,7 @@ QByteArray ModbusServer::processRtuRequest(const QByteArray &adu)
     responseAdu.append(responsePdu);
     
     // 计算并添加CRC校验码
-    quint16 crc = calculateCRC(responseAdu);
+    quint16 crc = ModbusRtuPort::calculateCRC(responseAdu);
     quint16 crcLe = qToLittleEndian(crc);
     responseAdu.append(reinterpret_cast<const char*>(&crcLe), 2);
 
@@ -364,35 +835,63 @@ QByteArray ModbusServer::processRtuRequest(const QByteArray &adu)
     return responseAdu;
 }
 
-quint16 ModbusServer::calculateCRC(const QByteArray &data)
-{
-    quint16 crc = 0xFFFF;
-    
-    for (int i = 0; i < data.size(); ++i) {
-        crc ^= static_cast<quint8>(data[i]);
-        
-        for (int j = 0; j < 8; ++j) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc >>= 1;
-            }
-        }
-    }
-    
-    return crc;
-}
-
 // ========== 通用控制 ==========
 
 void ModbusServer::stop()
 {
     stopTcp();
+    stopRtuOverTcp();
+    stopUdp();
     stopRtu();
     
     m_running = false;
     setStatusMessage("服务器已停止");
     emit runningChanged(false);
+    emit transportsChanged();
+}
+
+QStringList ModbusServer::activeTransports() const
+{
+    QStringList transports;
+    if (m_tcpServer) {
+        transports.append(QString("TCP:%1").arg(m_tcpPort));
+    }
+    if (m_rtuOverTcpServer) {
+        transports.append(QString("RTU-TCP:%1").arg(m_rtuOverTcpPort));
+    }
+    if (m_udpTransport) {
+        transports.append(QString("UDP:%1").arg(m_udpTransport->port()));
+    }
+    for (auto it = m_rtuPorts.cbegin(); it != m_rtuPorts.cend(); ++it) {
+        transports.append(QString("RTU:%1").arg(it.key()));
+    }
+    return transports;
+}
+
+void ModbusServer::transportStarted(ModbusMode mode, const QString &message)
+{
+    // 从全部停止状态启动时清零请求计数
+    if (!m_running) {
+        m_running = true;
+        m_requestCount = 0;
+        emit runningChanged(true);
+        emit requestCountChanged(m_requestCount);
+    }
+
+    m_mode = mode;
+    setStatusMessage(message);
+    emit modeChanged(m_mode);
+    emit transportsChanged();
+}
+
+void ModbusServer::updateRunningState()
+{
+    bool running = m_tcpServer || m_rtuOverTcpServer || m_udpTransport || !m_rtuPorts.isEmpty();
+    if (m_running != running) {
+        m_running = running;
+        emit runningChanged(running);
+    }
+    emit transportsChanged();
 }
 
 void ModbusServer::initializeData()
@@ -428,135 +927,117 @@ QStringList ModbusServer::getFileList() const
 // 查询文件内容
 QString ModbusServer::queryFileContent(int fileNumber, int maxRecords)
 {
-    QString result;
-    result += QString("========== 文件 %1 内容查询 ==========\n\n").arg(fileNumber);
-    
-    // 获取文件信息
-    QString info = m_fileStore->getFileInfo(fileNumber);
-    result += info + "\n\n";
-    
-    // 获取所有记录（原始字节数据）
-    QMap<quint16, QByteArray> records = m_fileStore->getAllRecordsRaw(fileNumber, maxRecords);
-    
-    if (records.isEmpty()) {
-        result += "该文件暂无数据写入\n";
+    return queryFilePage(fileNumber, 0, maxRecords).value(QStringLiteral("text")).toString();
+}
+
+QVariantMap ModbusServer::queryFilePage(int fileNumber, int cursor, int pageSize)
+{
+    QVariantMap page;
+    QVector<int> recordNumbers;
+    QByteArray data;
+    int nextCursor = -1;
+    int writtenCount = 0;
+    pageSize = qBound(1, pageSize, ModbusConst::MAX_FILE_RECORDS);
+
+    // 只复制本页的记录，每行定长，按行数预分配
+    const bool found = m_fileStore->readWrittenPage(quint16(fileNumber), cursor, pageSize,
+                                                    &recordNumbers, &data, &nextCursor, &writtenCount);
+    HexDumpFormatter out(512 + recordNumbers.size() * 64);
+
+    if (cursor <= 0) {
+        out.appendText(QString("========== 文件 %1 内容查询 ==========\n\n").arg(fileNumber));
+        out.appendText(m_fileStore->getFileInfo(quint16(fileNumber)));
+        out.appendLatin1("\n\n");
+    }
+
+    if (!found) {
+        out.appendText(QString("文件 %1 不存在\n").arg(fileNumber));
+    } else if (recordNumbers.isEmpty()) {
+        out.appendText(cursor <= 0 ? QStringLiteral("该文件暂无数据写入\n")
+                                   : QString("记录 %1 之后没有已写入的记录\n").arg(cursor));
     } else {
-        result += QString("已写入的记录（最多显示 %1 条）：\n").arg(maxRecords);
-        result += "记录号  十六进制                            ASCII字符串\n";
-        result += "------  --------------------------------    ----------------------\n";
-        
-        for (auto it = records.begin(); it != records.end(); ++it) {
-            quint16 recordNum = it.key();
-            QByteArray data = it.value();
-            
-            // 十六进制显示
-            QString hexStr;
-            for (int i = 0; i < data.size(); ++i) {
-                hexStr += QString("%1 ").arg((unsigned char)data[i], 2, 16, QChar('0')).toUpper();
-            }
-            hexStr = hexStr.leftJustified(36, ' ');
-            
-            // ASCII显示（可打印字符）
-            QString asciiStr;
-            for (int i = 0; i < data.size(); ++i) {
-                char c = data[i];
-                if (c >= 32 && c <= 126) {  // 可打印字符
-                    asciiStr += c;
-                } else {
-                    asciiStr += '.';
-                }
-            }
-            
-            result += QString("%1    %2  %3\n")
-                    .arg(recordNum, 6)
-                    .arg(hexStr)
-                    .arg(asciiStr);
+        out.appendText(QString("已写入的记录（记录 %1 起，每页最多 %2 条）：\n").arg(qMax(0, cursor)).arg(pageSize));
+        out.appendText(QStringLiteral("记录号  十六进制                            ASCII字符串\n"));
+        out.appendLatin1("------  --------------------------------    ----------------------\n");
+
+        const char *record = data.constData();
+        for (int recordNumber : std::as_const(recordNumbers)) {
+            out.appendNumber(recordNumber, 6);
+            out.appendChar(' ', 4);
+            out.appendHex(record, 2, 36);
+            out.appendChar(' ', 2);
+            out.appendAscii(record, 2);
+            out.appendChar('\n');
+            record += 2;
         }
-        
-        result += QString("\n总计: %1 条记录\n").arg(records.size());
+
+        out.appendText(nextCursor >= 0
+                       ? QString("\n本页 %1 条，共 %2 条已写入，下一页从记录 %3 开始\n")
+                         .arg(recordNumbers.size()).arg(writtenCount).arg(nextCursor)
+                       : QString("\n本页 %1 条，共 %2 条已写入，已到末尾\n")
+                         .arg(recordNumbers.size()).arg(writtenCount));
     }
-    
-    result += "\n" + QString("=").repeated(40) + "\n";
-    return result;
+
+    page.insert(QStringLiteral("text"), out.toString());
+    page.insert(QStringLiteral("nextCursor"), nextCursor);
+    page.insert(QStringLiteral("count"), int(recordNumbers.size()));
+    return page;
 }
 
 QString ModbusServer::queryAddressFile(int startAddress, int count)
 {
-    QString result;
-    result += QString("========== 保持寄存器查询 ==========\n\n");
-    result += QString("起始地址: %1\n").arg(startAddress);
-    result += QString("查询数量: %1\n\n").arg(count);
-    
-    // 从ModbusDataStore读取保持寄存器
-    QMap<quint16, QByteArray> data;
-    bool hasData = false;
-    
-    for (int i = 0; i < count; ++i) {
-        quint16 addr = startAddress + i;
-        quint16 value = m_dataStore->readHoldingRegister(addr);
-        
-        // 将16位值转换为大端字节序的2字节数据
-        QByteArray bytes(2, 0);
-        bytes[0] = static_cast<char>((value >> 8) & 0xFF);  // 高字节
-        bytes[1] = static_cast<char>(value & 0xFF);         // 低字节
-        
-        // 只记录非零的寄存器
+    return queryRegisterPage(startAddress, count).value(QStringLiteral("text")).toString();
+}
+
+QVariantMap ModbusServer::queryRegisterPage(int startAddress, int count)
+{
+    QVariantMap page;
+    startAddress = qBound(0, startAddress, int(ModbusConst::MAX_REGISTERS));
+    count = qBound(1, count, qMin<int>(ModbusConst::MAX_READ_REGISTERS, 0x10000 - startAddress));
+
+    // 一次加锁批量读取整页
+    QVector<quint16> values;
+    m_dataStore->readHoldingRegisters(quint16(startAddress), quint16(count), values);
+
+    int nonZeroCount = 0;
+    for (quint16 value : std::as_const(values)) {
         if (value != 0) {
-            hasData = true;
+            nonZeroCount++;
         }
-        data[addr] = bytes;
     }
-    
-    if (!hasData) {
-        result += "该地址区域暂无数据写入（所有值为0）\n";
+
+    HexDumpFormatter out(512 + values.size() * 72);
+    out.appendText(QStringLiteral("========== 保持寄存器查询 ==========\n\n"));
+    out.appendText(QString("起始地址: %1\n查询数量: %2\n\n").arg(startAddress).arg(count));
+
+    if (nonZeroCount == 0) {
+        out.appendText(QStringLiteral("该地址区域暂无数据写入（所有值为0）\n"));
     } else {
-        result += QString("保持寄存器数据（显示 %1 个地址）：\n").arg(count);
-        result += "地址    十进制值  十六进制                        ASCII字符串\n";
-        result += "------  --------  --------------------------------  ----------------------\n";
-        
-        for (auto it = data.begin(); it != data.end(); ++it) {
-            quint16 address = it.key();
-            QByteArray bytes = it.value();
-            
-            // 转换回16位值用于十进制显示
-            quint16 value = ((unsigned char)bytes[0] << 8) | (unsigned char)bytes[1];
-            
-            // 十六进制显示
-            QString hexStr;
-            for (int i = 0; i < bytes.size(); ++i) {
-                hexStr += QString("%1 ").arg((unsigned char)bytes[i], 2, 16, QChar('0')).toUpper();
-            }
-            hexStr = hexStr.leftJustified(34, ' ');
-            
-            // ASCII显示（可打印字符）
-            QString asciiStr;
-            for (int i = 0; i < bytes.size(); ++i) {
-                char c = bytes[i];
-                if (c >= 32 && c <= 126) {  // 可打印字符
-                    asciiStr += c;
-                } else {
-                    asciiStr += '.';
-                }
-            }
-            
-            result += QString("%1    %2    %3  %4\n")
-                    .arg(address, 6)
-                    .arg(value, 8)
-                    .arg(hexStr)
-                    .arg(asciiStr);
-        }
-        
-        // 统计非零值数量
-        int nonZeroCount = 0;
-        for (auto it = data.begin(); it != data.end(); ++it) {
-            quint16 value = ((unsigned char)it.value()[0] << 8) | (unsigned char)it.value()[1];
-            if (value != 0) nonZeroCount++;
+        out.appendText(QString("保持寄存器数据（显示 %1 个地址）：\n").arg(count));
+        out.appendText(QStringLiteral("地址    十进制值  十六进制                        ASCII字符串\n"));
+        out.appendLatin1("------  --------  --------------------------------  ----------------------\n");
+
+        for (int i = 0; i < values.size(); ++i) {
+            const quint16 value = values.at(i);
+            const char bytes[2] = { char(value >> 8), char(value & 0xFF) };  // 大端
+            out.appendNumber(startAddress + i, 6);
+            out.appendChar(' ', 4);
+            out.appendNumber(value, 8);
+            out.appendChar(' ', 4);
+            out.appendHex(bytes, 2, 34);
+            out.appendChar(' ', 2);
+            out.appendAscii(bytes, 2);
+            out.appendChar('\n');
         }
-        result += QString("\n总计: %1 个地址，其中 %2 个非零值\n").arg(data.size()).arg(nonZeroCount);
+
+        out.appendText(QString("\n总计: %1 个地址，其中 %2 个非零值\n").arg(values.size()).arg(nonZeroCount));
     }
-    
-    result += "\n" + QString("=").repeated(40) + "\n";
-    return result;
+
+    const int nextCursor = startAddress + count <= int(ModbusConst::MAX_REGISTERS) ? startAddress + count : -1;
+    page.insert(QStringLiteral("text"), out.toString());
+    page.insert(QStringLiteral("nextCursor"), nextCursor);
+    page.insert(QStringLiteral("count"), count);
+    return page;
 }
 
 // ========== 功能码路由 ==========
@@ -595,6 +1076,11 @@ QByteArray ModbusServer::routeFunctionCode(quint8 functionCode, const QByteArray
     case WriteFile:
         response = m_addressStore->handleWriteFile(pdu);
         break;
+
+    // 窗口化文件传输：205
+    case FileTransfer:
+        response = m_fileTransfer->handleRequest(pdu);
+        break;
         
     default:
         // 返回非法功能错误
@@ -610,64 +1096,6 @@ QByteArray ModbusServer::routeFunctionCode(quint8 functionCode, const QByteArray
     return response;
 }
 
-int ModbusServer::getExpectedFrameLength(quint8 functionCode, const QByteArray &buffer)
-{
-    // RTU帧结构：从站地址(1) + 功能码(1) + 数据(N) + CRC(2)
-    int minLength = 4;  // 最小长度
-    
-    if (buffer.size() < 3) {
-        return -1;  // 数据不足，无法判断
-    }
-    
-    switch (functionCode) {
-    case ReadCoils:           // 0x01
-    case ReadDiscreteInputs:  // 0x02
-    case ReadHoldingRegisters:// 0x03
-    case ReadInputRegisters:  // 0x04
-        // 读请求：从站地址 + 功能码 + 起始地址(2) + 数量(2) + CRC(2) = 8字节
-        return 8;
-        
-    case WriteSingleCoil:     // 0x05
-    case WriteSingleRegister: // 0x06
-        // 写单个：从站地址 + 功能码 + 地址(2) + 值(2) + CRC(2) = 8字节
-        return 8;
-        
-    case WriteMultipleCoils:  // 0x0F
-    case WriteMultipleRegisters: // 0x10
-        if (buffer.size() >= 7) {
-            quint8 byteCount = static_cast<quint8>(buffer.at(6));
-            // 从站地址 + 功能码 + 起始地址(2) + 数量(2) + 字节数(1) + 数据(N) + CRC(2)
-            return 7 + byteCount + 2;
-        }
-        return -1;
-        
-    case ReadFileRecord:  // 0x14 (20)
-        if (buffer.size() >= 3) {
-            quint8 byteCount = static_cast<quint8>(buffer.at(2));
-            // 从站地址 + 功能码 + 字节数(1) + 数据(N) + CRC(2)
-            return 3 + byteCount + 2;
-        }
-        return -1;
-        
-    case WriteFileRecord: // 0x15 (21)
-        if (buffer.size() >= 3) {
-            quint8 byteCount = static_cast<quint8>(buffer.at(2));
-            // 从站地址 + 功能码 + 字节数(1) + 数据(N) + CRC(2)
-            return 3 + byteCount + 2;
-        }
-        return -1;
-        
-    case ReadFile:    // 0xCB (203)
-    case WriteFile:   // 0xCC (204)
-        // 自定义功能码：从站地址 + 功能码 + 文件编号(2) + CRC(2) = 6字节
-        return 6;
-        
-    default:
-        // 未知功能码，返回最小长度
-        return minLength;
-    }
-}
-
 // ========== 辅助方法 ==========
 
 QString ModbusServer::formatPacket(const QByteArray &data, const QString &prefix)
@@ -11,14 +11,54 @@
 #include <QObject>
 #include <QTcpServer>
 #include <QTcpSocket>
-#include <QSerialPort>
 #include <QTimer>
+#include <QHash>
+#include <QMap>
+#include <QQueue>
+#include <QSet>
+#include <QElapsedTimer>
+#include <QVariantMap>
 #include "ModbusTypes.h"
+#include "ModbusRingBuffer.h"
+#include "ModbusLoadControl.h"
+#include "ModbusRtuPort.h"
+#include "ModbusUdpTransport.h"
 #include "ModbusDataStore.h"
 #include "ModbusFunctionHandler.h"
 #include "FileStore.h"
+#include "FileTransferService.h"
 
-// Modbus TCP/RTU 服务器
+class QThread;
+
+// 单个TCP连接的全部状态（套接字、接收缓冲区等集中在一个结构中）
+struct TcpConnection
+{
+    // 帧格式：标准 Modbus TCP（MBAP 头）或串口服务器透传的 RTU 帧（含 CRC）
+    enum Framing { FramingMbap, FramingRtu };
+
+    TcpConnection(QTcpSocket *s, Framing f)
+        : socket(s), framing(f), rxBuffer(ModbusConst::TCP_RX_BUFFER_SIZE) {}
+
+    QTcpSocket *socket;
+    Framing framing;
+    ModbusRingBuffer rxBuffer;  // 接收环形缓冲区
+    QByteArray scratch;         // 帧跨越环尾时的拼接缓冲
+    TokenBucket quota;          // 客户端请求配额
+    qint64 lastActivityMs = 0;  // 最后一次收到数据的时间（服务器时钟）
+    int discardedBytes = 0;     // 自上一个合法帧以来为重同步丢弃的字节数
+    bool scheduled = false;     // 已在调度队列中
+    bool closing = false;       // 已断开，等待套接字销毁
+    int verifiedLength = 0;     // RTU 帧：队首帧已通过 CRC 校验的长度
+};
+
+// 一条 RTU 串口链路及其 I/O 线程
+struct RtuLink
+{
+    QThread *thread;
+    ModbusRtuPort *port;
+};
+
+// Modbus TCP/UDP/RTU 服务器（TCP、UDP、RTU over TCP 监听与多个 RTU 串口可同时运行，共享同一个数据存储）
 class ModbusServer : public QObject
 {
     Q_OBJECT
@@ -29,6 +69,8 @@ class ModbusServer : public QObject
     // 状态变化用 runningChanged 标记
     Q_PROPERTY(bool running READ isRunning NOTIFY runningChanged)
     Q_PROPERTY(ModbusMode mode READ mode NOTIFY modeChanged)
+    Q_PROPERTY(bool tcpRunning READ isTcpRunning NOTIFY transportsChanged)
+    Q_PROPERTY(QStringList activeTransports READ activeTransports NOTIFY transportsChanged)
     Q_PROPERTY(QString statusMessage READ statusMessage NOTIFY statusMessageChanged)
     Q_PROPERTY(int requestCount READ requestCount NOTIFY requestCountChanged)
     Q_PROPERTY(int lastFunctionCode READ lastFunctionCode NOTIFY lastFunctionCodeChanged)
@@ -42,24 +84,68 @@ public:
     Q_INVOKABLE bool startTcp(quint16 port = 502);
     Q_INVOKABLE void stopTcp();
 
-    // RTU 服务器控制
+    // TCP 连接限制
+    Q_INVOKABLE void setMaxTcpConnections(int count) { m_maxTcpConnections = qMax(1, count); }
+    Q_INVOKABLE void setTcpIdleTimeout(int msecs) { m_tcpIdleTimeoutMs = msecs; }  // <= 0 表示不回收
+    int tcpConnectionCount() const { return m_tcpConnections.size(); }
+
+    // 准入控制：超出阈值的请求立即以 SlaveDeviceBusy 应答
+    Q_INVOKABLE void setAdmissionLimits(int maxEventLoopLagMs, int maxQueuedBytes);
+    Q_INVOKABLE void setClientQuota(double ratePerSecond, int burst);  // ratePerSecond <= 0 表示不限流
+    int shedRequestCount() const { return m_shedCount; }
+
+    // 请求调度：每个连接每轮最多处理的帧数，写请求和指定单元ID优先
+    Q_INVOKABLE void setSchedulerQuantum(int framesPerTurn);
+    Q_INVOKABLE void setPriorityUnitIds(const QList<int> &unitIds);
+    Q_INVOKABLE void setPrioritizeWrites(bool enabled) { m_prioritizeWrites = enabled; }
+
+    // RTU over TCP 服务器控制（接收串口服务器透传的 RTU 帧，可同时接入多个网关）
+    Q_INVOKABLE bool startRtuOverTcp(quint16 port = 4001);
+    Q_INVOKABLE void stopRtuOverTcp();
+    quint16 rtuOverTcpPort() const { return m_rtuOverTcpPort; }
+
+    // UDP 服务器控制（复用 MBAP 帧格式，无连接状态）
+    Q_INVOKABLE bool startUdp(quint16 port = 502);
+    Q_INVOKABLE void stopUdp();
+
+    // RTU 服务器控制（可多次调用打开多个串口，每个串口运行在独立线程中）
     Q_INVOKABLE bool startRtu(const QString &portName, int baudRate = 9600);
-    Q_INVOKABLE void stopRtu();
+    Q_INVOKABLE void stopRtuPort(const QString &portName);
+    Q_INVOKABLE void stopRtu();  // 关闭所有串口
+
+    // RTU 多站总线：只应答列出的从站地址（空列表表示全部应答），广播地址 0 只执行不应答
+    Q_INVOKABLE void setRtuSlaveIds(const QList<int> &slaveIds) { m_rtuAddressFilter.setAddresses(slaveIds); }
 
     // 通用控制
     Q_INVOKABLE void stop();
 
     // 数据初始化
     Q_INVOKABLE void initializeData(); 
+
+    // 文件记录持久化：加载目录中已有的文件，之后的文件映射到磁盘并在后台刷盘
+    Q_INVOKABLE bool setFileStorageDirectory(const QString &path) { return m_fileStore->setStorageDirectory(path); }
+    // 只在内存中的文件和地址文件（203/204）按页压缩（稀疏或重复内容的大文件占用大幅下降，最近访问的页保持解压）
+    Q_INVOKABLE void setFileCompression(bool enabled)
+    {
+        m_fileStore->setCompression(enabled);
+        m_addressStore->setCompression(enabled);
+    }
     
     // 文件查询
     Q_INVOKABLE QStringList getFileList() const;
     Q_INVOKABLE QString queryFileContent(int fileNumber, int maxRecords = 100);
     Q_INVOKABLE QString queryAddressFile(int startAddress, int count = 50);
 
+    // 分页查询，返回 { text, nextCursor（下一页起点，-1 表示没有更多）, count }
+    // 文件按已写入记录翻页，每次只复制一页数据；寄存器每页最多 125 个
+    Q_INVOKABLE QVariantMap queryFilePage(int fileNumber, int cursor = 0, int pageSize = 100);
+    Q_INVOKABLE QVariantMap queryRegisterPage(int startAddress, int count = 50);
+
     // 获取器
     bool isRunning() const { return m_running; } // const表示该方法不会修改对象的成员变量
-    ModbusMode mode() const { return m_mode; }
+    ModbusMode mode() const { return m_mode; }  // 最近启动的传输方式
+    bool isTcpRunning() const { return m_tcpServer != nullptr; }
+    QStringList activeTransports() const;
     QString statusMessage() const { return m_statusMessage; }
     int requestCount() const { return m_requestCount; }
     int lastFunctionCode() const { return m_lastFunctionCode; }
@@ -70,6 +156,7 @@ public:
 signals:
     void runningChanged(bool running);
     void modeChanged(ModbusMode mode);
+    void transportsChanged();
     void statusMessageChanged(const QString &message);
     void requestCountChanged(int count);
     void lastFunctionCodeChanged(int functionCode);
@@ -82,34 +169,76 @@ private slots:
     void onNewTcpConnection();
     void onTcpReadyRead();
     void onTcpDisconnected();
-    void onRtuReadyRead();
-    void onRtuError(QSerialPort::SerialPortError error);
+    void onTcpIdleCheck();
+    void onServeTurn();
+    void onRtuError(const QString &error);
 
 private:
+    void readTcpConnection(TcpConnection *conn);
+    int nextTcpFrameLength(TcpConnection *conn);
+    int nextRtuFrameLength(TcpConnection *conn);
+    bool isPriorityFrame(const TcpConnection *conn) const;
+    void enqueueTcpConnection(TcpConnection *conn);
+    void serveTcpQueue(QQueue<QTcpSocket*> &queue, bool priorityOnly);
+    void serveTcpConnection(TcpConnection *conn, bool priorityOnly);
+    bool resyncTcpStream(TcpConnection *conn);
+    void closeTcpConnection(TcpConnection *conn);
+    void closeTcpConnections(TcpConnection::Framing framing);
+    void updateLoadMonitors();
+    bool admitTcpRequest(TcpConnection *conn);
+    QByteArray buildTcpExceptionResponse(const QByteArray &adu, quint8 exceptionCode);
+    QByteArray buildRtuExceptionResponse(const QByteArray &adu, quint8 exceptionCode);
     QByteArray processTcpRequest(const QByteArray &adu);
-    QByteArray processRtuRequest(const QByteArray &adu);
+    QByteArray processUdpRequest(const QByteArray &adu);
+    QByteArray processRtuRequest(const QByteArray &adu);  // adu 必须是已通过 CRC 校验的完整帧
     QByteArray routeFunctionCode(quint8 functionCode, const QByteArray &pdu);
-    quint16 calculateCRC(const QByteArray &data);
-    int getExpectedFrameLength(quint8 functionCode, const QByteArray &buffer);
     QString formatPacket(const QByteArray &data, const QString &prefix);
     void setStatusMessage(const QString &message);
     void incrementRequestCount();
+    void transportStarted(ModbusMode mode, const QString &message);
+    void updateRunningState();
 
     // TCP
     QTcpServer *m_tcpServer;
-    QList<QTcpSocket*> m_tcpClients;
-    QMap<QTcpSocket*, QByteArray> m_tcpBuffers;
-
-    // RTU
-    QSerialPort *m_serialPort;
-    QByteArray m_rtuBuffer;
-    QTimer *m_rtuTimer;
+    quint16 m_tcpPort;
+    QTcpServer *m_rtuOverTcpServer;
+    quint16 m_rtuOverTcpPort;
+    QHash<QTcpSocket*, TcpConnection*> m_tcpConnections;
+    QTimer *m_tcpIdleTimer;
+    QElapsedTimer m_clock;
+    int m_maxTcpConnections;
+    int m_tcpIdleTimeoutMs;
+
+    // 准入控制
+    EventLoopLagMonitor *m_lagMonitor;
+    qsizetype m_queuedBytes;    // 所有连接接收缓冲区中尚未处理的字节数
+    int m_maxEventLoopLagMs;
+    int m_maxQueuedBytes;
+    double m_clientQuotaRate;
+    int m_clientQuotaBurst;
+    int m_shedCount;
+
+    // 公平调度
+    QQueue<QTcpSocket*> m_priorityQueue;
+    QQueue<QTcpSocket*> m_normalQueue;
+    int m_framesPerTurn;
+    QSet<quint8> m_priorityUnitIds;
+    bool m_prioritizeWrites;
+    bool m_serveTurnPending;
+
+    // UDP
+    ModbusUdpTransport *m_udpTransport;
+
+    // RTU（串口名 -> 链路）
+    QMap<QString, RtuLink> m_rtuPorts;
+    RtuAddressFilter m_rtuAddressFilter;  // 所有 RTU 链路共用
 
     // 数据存储
     ModbusDataStore *m_dataStore;
     ModbusFunctionHandler *m_functionHandler;
     FileStore *m_fileStore;
     FileAddressStore *m_addressStore;
+    FileTransferService *m_fileTransfer;
 
     // 状态
     bool m_running;
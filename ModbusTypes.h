@@ -16,7 +16,17 @@ enum ModbusFunctionCode : quint8 { // 强枚举类型，类型安全，确保底
     ReadFileRecord = 0x14,          // 读文件记录 (20)
     WriteFileRecord = 0x15,         // 写文件记录 (21)
     ReadFile = 0xCB,                // 自定义读文件 (203)
-    WriteFile = 0xCC                // 自定义写文件 (204)
+    WriteFile = 0xCC,               // 自定义写文件 (204)
+    FileTransfer = 0xCD             // 自定义窗口化文件传输 (205)
+};
+
+// 文件传输（功能码 0xCD）子命令
+enum FileTransferCommand : quint8 {
+    TransferOpen = 0x01,            // 打开会话：起始文件号(2) + 总字节数(4)
+    TransferData = 0x02,            // 数据块：会话ID(2) + 序号(4) + 字节数(1) + 数据(N)
+    TransferCommit = 0x03,          // 提交：会话ID(2) + CRC32(4)
+    TransferStatus = 0x04,          // 查询进度：会话ID(2)
+    TransferAbort = 0x05            // 中止：会话ID(2)
 };
 
 // Modbus 异常码
@@ -33,7 +43,9 @@ enum ModbusExceptionCode : quint8 {
 // Modbus 通信模式
 enum ModbusMode {
     ModeTCP,
-    ModeRTU
+    ModeRTU,
+    ModeUDP,
+    ModeRtuOverTcp   // 串口服务器透传的 RTU 帧
 };
 
 // Modbus 数据区类型
@@ -53,6 +65,27 @@ namespace ModbusConst {
     constexpr quint16 MAX_WRITE_COILS = 1968;
     constexpr quint16 MAX_WRITE_REGISTERS = 123;
     constexpr quint16 MAX_FILE_RECORDS = 10000;
+    constexpr int MAX_PDU_SIZE = 253;           // PDU 最大长度
+    constexpr int MBAP_HEADER_SIZE = 7;         // MBAP 头长度（事务ID + 协议ID + 长度 + 单元ID）
+    constexpr int MAX_TCP_ADU_SIZE = MBAP_HEADER_SIZE + MAX_PDU_SIZE;  // 260
+    constexpr int MAX_RTU_ADU_SIZE = 1 + MAX_PDU_SIZE + 2;             // 256（从站地址 + PDU + CRC）
+    constexpr int TCP_RX_BUFFER_SIZE = 4096;    // 每个TCP连接的接收环形缓冲区容量
+    constexpr int TCP_MAX_RESYNC_BYTES = 1024;  // 两个合法帧之间允许为重同步丢弃的最大字节数，超出则断开
+    constexpr int TCP_MAX_CONNECTIONS = 64;     // 默认全局TCP连接数上限
+    constexpr int TCP_IDLE_TIMEOUT_MS = 60000;  // 默认空闲连接超时（毫秒）
+    constexpr int ADMISSION_MAX_LAG_MS = 200;   // 事件循环延迟超过该值时以 SlaveDeviceBusy 拒绝请求
+    // 所有连接排队数据超过该值时拒绝请求；排队总量不会超过 连接数上限 × 接收缓冲区容量，取其一半
+    constexpr int ADMISSION_MAX_QUEUED_BYTES = TCP_MAX_CONNECTIONS * TCP_RX_BUFFER_SIZE / 2;  // 128KB
+    constexpr double CLIENT_QUOTA_RATE = 1000.0;  // 每个客户端默认请求速率上限（次/秒）
+    constexpr int CLIENT_QUOTA_BURST = 200;       // 每个客户端默认突发请求数
+    constexpr int SCHEDULER_FRAMES_PER_TURN = 4;  // 每个连接每轮调度最多处理的帧数
+    constexpr int UDP_BATCH_SIZE = 64;            // UDP 每次系统调用批量收发的数据报数
+    constexpr int FILE_BYTES = MAX_FILE_RECORDS * 2;        // 每个文件的字节容量（20000）
+    constexpr int FILE_TRANSFER_CHUNK_SIZE = 240;           // 文件传输每块数据字节数（偶数，按记录对齐）
+    constexpr int FILE_TRANSFER_WINDOW = 32;                // 文件传输允许未确认的块数
+    constexpr int FILE_TRANSFER_MAX_SESSIONS = 8;           // 同时进行的文件传输会话上限
+    constexpr int FILE_TRANSFER_TIMEOUT_MS = 30000;         // 文件传输会话空闲超时（毫秒）
+    constexpr int FILE_FLUSH_INTERVAL_MS = 1000;            // 磁盘文件脏页后台同步周期（毫秒）
 }
 
 #endif // MODBUSTYPES_H
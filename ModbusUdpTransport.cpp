@@ -0,0 +1,239 @@
+/**
+ * @file ModbusUdpTransport.cpp
+ * @brief Modbus UDP 传输实现
+ */
+
+#include "ModbusUdpTransport.h"
+#include "ModbusTypes.h"
+#include <QNetworkDatagram>
+#include <QtEndian>
+#include <QDebug>
+
+#ifdef Q_OS_LINUX
+#include <QSocketNotifier>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+// 每个接收槽位的大小：大于最大 MBAP 帧，超长数据报会被标记为截断并丢弃
+static constexpr int UDP_SLOT_SIZE = 512;
+#endif
+
+ModbusUdpTransport::ModbusUdpTransport(RequestHandler handler, QObject *parent)
+    : QObject(parent)
+#ifdef Q_OS_LINUX
+    , m_fd(-1)
+    , m_notifier(nullptr)
+#endif
+    , m_handler(std::move(handler))
+    , m_socket(nullptr)
+    , m_port(0)
+{
+}
+
+ModbusUdpTransport::~ModbusUdpTransport()
+{
+    close();
+}
+
+bool ModbusUdpTransport::open(quint16 port)
+{
+    close();
+    m_errorString.clear();
+
+#ifdef Q_OS_LINUX
+    if (!openNative(port)) {
+        return false;
+    }
+#else
+    m_socket = new QUdpSocket(this);
+    if (!m_socket->bind(QHostAddress::Any, port)) {
+        m_errorString = m_socket->errorString();
+        delete m_socket;
+        m_socket = nullptr;
+        return false;
+    }
+    connect(m_socket, &QUdpSocket::readyRead, this, &ModbusUdpTransport::onReadyRead);
+#endif
+
+    m_port = port;
+    return true;
+}
+
+void ModbusUdpTransport::close()
+{
+#ifdef Q_OS_LINUX
+    if (m_notifier) {
+        m_notifier->setEnabled(false);
+        delete m_notifier;
+        m_notifier = nullptr;
+    }
+    if (m_fd >= 0) {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+#endif
+
+    if (m_socket) {
+        m_socket->close();
+        delete m_socket;
+        m_socket = nullptr;
+    }
+    m_port = 0;
+}
+
+void ModbusUdpTransport::onReadyRead()
+{
+#ifdef Q_OS_LINUX
+    processNativeBatch();
+#else
+    while (m_socket && m_socket->hasPendingDatagrams()) {
+        QNetworkDatagram datagram = m_socket->receiveDatagram(ModbusConst::MAX_TCP_ADU_SIZE + 1);
+        const QByteArray data = datagram.data();
+        QByteArray response = handleDatagram(data.constData(), data.size());
+        if (!response.isEmpty()) {
+            m_socket->writeDatagram(datagram.makeReply(response));
+        }
+    }
+#endif
+}
+
+QByteArray ModbusUdpTransport::handleDatagram(const char *data, qsizetype size)
+{
+    // 一个数据报必须恰好是一个完整的 MBAP 帧，否则直接丢弃
+    if (size < 8 || size > ModbusConst::MAX_TCP_ADU_SIZE) {
+        return QByteArray();
+    }
+
+    const uchar *header = reinterpret_cast<const uchar*>(data);
+    quint16 protocolId = qFromBigEndian<quint16>(header + 2);
+    quint16 length = qFromBigEndian<quint16>(header + 4);
+    if (protocolId != 0 || 6 + length != size) {
+        return QByteArray();
+    }
+
+    // 处理期间直接引用接收缓冲区，不做拷贝
+    return m_handler(QByteArray::fromRawData(data, size));
+}
+
+#ifdef Q_OS_LINUX
+
+bool ModbusUdpTransport::openNative(quint16 port)
+{
+    // 优先使用 IPv6 双栈套接字，同时接收 IPv4 请求
+    int fd = ::socket(AF_INET6, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd >= 0) {
+        int v6only = 0;
+        ::setsockopt(fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+
+        sockaddr_in6 addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin6_family = AF_INET6;
+        addr.sin6_addr = in6addr_any;
+        addr.sin6_port = qToBigEndian(port);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            ::close(fd);
+            fd = -1;
+        }
+    }
+
+    // 系统不支持 IPv6 时退回 IPv4
+    if (fd < 0) {
+        fd = ::socket(AF_INET, SOCK_DGRAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+        if (fd < 0) {
+            m_errorString = QString::fromLocal8Bit(std::strerror(errno));
+            return false;
+        }
+
+        sockaddr_in addr;
+        std::memset(&addr, 0, sizeof(addr));
+        addr.sin_family = AF_INET;
+        addr.sin_addr.s_addr = qToBigEndian(quint32(INADDR_ANY));
+        addr.sin_port = qToBigEndian(port);
+        if (::bind(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+            m_errorString = QString::fromLocal8Bit(std::strerror(errno));
+            ::close(fd);
+            return false;
+        }
+    }
+
+    m_fd = fd;
+    m_rxBuffers.resize(ModbusConst::UDP_BATCH_SIZE * UDP_SLOT_SIZE);
+    m_responses.reserve(ModbusConst::UDP_BATCH_SIZE);
+
+    m_notifier = new QSocketNotifier(fd, QSocketNotifier::Read, this);
+    connect(m_notifier, &QSocketNotifier::activated, this, &ModbusUdpTransport::onReadyRead);
+    return true;
+}
+
+void ModbusUdpTransport::processNativeBatch()
+{
+    constexpr int batch = ModbusConst::UDP_BATCH_SIZE;
+    mmsghdr rxMsgs[batch];
+    iovec rxIov[batch];
+    sockaddr_storage peers[batch];
+    mmsghdr txMsgs[batch];
+    iovec txIov[batch];
+
+    char *slotBase = m_rxBuffers.data();
+
+    // 循环批量读取直到套接字读空，每批一次系统调用收、一次系统调用发
+    for (;;) {
+        for (int i = 0; i < batch; ++i) {
+            rxIov[i].iov_base = slotBase + i * UDP_SLOT_SIZE;
+            rxIov[i].iov_len = UDP_SLOT_SIZE;
+            std::memset(&rxMsgs[i], 0, sizeof(mmsghdr));
+            rxMsgs[i].msg_hdr.msg_iov = &rxIov[i];
+            rxMsgs[i].msg_hdr.msg_iovlen = 1;
+            rxMsgs[i].msg_hdr.msg_name = &peers[i];
+            rxMsgs[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        }
+
+        int received = ::recvmmsg(m_fd, rxMsgs, batch, MSG_DONTWAIT, nullptr);
+        if (received <= 0) {
+            break;  // EAGAIN：已读空
+        }
+
+        m_responses.clear();
+        int pending = 0;
+        for (int i = 0; i < received; ++i) {
+            if (rxMsgs[i].msg_hdr.msg_flags & MSG_TRUNC) {
+                continue;  // 超长数据报
+            }
+
+            QByteArray response = handleDatagram(slotBase + i * UDP_SLOT_SIZE, rxMsgs[i].msg_len);
+            if (response.isEmpty()) {
+                continue;
+            }
+
+            // QByteArray 数据区不随容器搬移，可直接让 iovec 指向
+            m_responses.append(response);
+            txIov[pending].iov_base = const_cast<char*>(m_responses.last().constData());
+            txIov[pending].iov_len = response.size();
+            std::memset(&txMsgs[pending], 0, sizeof(mmsghdr));
+            txMsgs[pending].msg_hdr.msg_iov = &txIov[pending];
+            txMsgs[pending].msg_hdr.msg_iovlen = 1;
+            txMsgs[pending].msg_hdr.msg_name = &peers[i];
+            txMsgs[pending].msg_hdr.msg_namelen = rxMsgs[i].msg_hdr.msg_namelen;
+            ++pending;
+        }
+
+        int sent = 0;
+        while (sent < pending) {
+            int n = ::sendmmsg(m_fd, txMsgs + sent, pending - sent, MSG_DONTWAIT);
+            if (n <= 0) {
+                qWarning() << "UDP 发送缓冲区已满，丢弃" << (pending - sent) << "个应答";
+                break;
+            }
+            sent += n;
+        }
+
+        if (received < batch) {
+            break;
+        }
+    }
+}
+
+#endif // Q_OS_LINUX
@@ -0,0 +1,59 @@
+/**
+ * @file ModbusUdpTransport.h
+ * @brief Modbus UDP 传输头文件
+ *
+ * 每个数据报携带一个完整的 MBAP 帧，无连接状态；
+ * Linux 下使用 recvmmsg/sendmmsg 批量收发，其他平台退回 QUdpSocket
+ */
+
+#ifndef MODBUSUDPTRANSPORT_H
+#define MODBUSUDPTRANSPORT_H
+
+#include <QObject>
+#include <QUdpSocket>
+#include <QVector>
+#include <functional>
+
+class QSocketNotifier;
+
+// Modbus UDP 传输
+class ModbusUdpTransport : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 请求处理回调：输入完整MBAP帧，返回应答帧（空表示不应答）
+    using RequestHandler = std::function<QByteArray(const QByteArray &adu)>;
+
+    explicit ModbusUdpTransport(RequestHandler handler, QObject *parent = nullptr);
+    ~ModbusUdpTransport();
+
+    bool open(quint16 port);
+    void close();
+
+    quint16 port() const { return m_port; }
+    QString errorString() const { return m_errorString; }
+
+private slots:
+    void onReadyRead();
+
+private:
+    QByteArray handleDatagram(const char *data, qsizetype size);
+
+#ifdef Q_OS_LINUX
+    bool openNative(quint16 port);
+    void processNativeBatch();
+
+    int m_fd;
+    QSocketNotifier *m_notifier;
+    QByteArray m_rxBuffers;             // 批量接收缓冲区（BATCH 个数据报槽位）
+    QVector<QByteArray> m_responses;    // 本批应答，需保持到 sendmmsg 完成
+#endif
+
+    RequestHandler m_handler;
+    QUdpSocket *m_socket;
+    quint16 m_port;
+    QString m_errorString;
+};
+
+#endif // MODBUSUDPTRANSPORT_H
@@ -5,6 +5,29 @@
 
 #include "ModbusValueConverter.h"
 #include <QDebug>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+// 四舍五入并饱和到整数类型 T 的范围（NaN 视为 0）
+template <typename T>
+T roundToInteger(double value)
+{
+    if (std::isnan(value)) {
+        return 0;
+    }
+    value = std::round(value);
+    if (value <= double(std::numeric_limits<T>::min())) {
+        return std::numeric_limits<T>::min();
+    }
+    if (value >= double(std::numeric_limits<T>::max())) {
+        return std::numeric_limits<T>::max();
+    }
+    return static_cast<T>(value);
+}
+
+} // namespace
 
 // ==================== 类型信息查询 ====================
 
@@ -79,50 +102,78 @@ QString ModbusValueConverter::typeToString(ModbusDataValueType type)
     return "UINT16";
 }
 
+WordOrder ModbusValueConverter::parseWordOrder(const QString &orderStr)
+{
+    QString upper = orderStr.toUpper().trimmed();
+
+    if (upper == "CDAB" || upper == "3412" || upper == "WORDSWAP") {
+        return WordOrder::CDAB;
+    } else if (upper == "BADC" || upper == "2143" || upper == "BYTESWAP") {
+        return WordOrder::BADC;
+    } else if (upper == "DCBA" || upper == "4321" || upper == "LITTLE" || upper == "小端") {
+        return WordOrder::DCBA;
+    }
+
+    // 默认高字在前（ABCD/1234/BIG/大端）
+    return WordOrder::ABCD;
+}
+
+QString ModbusValueConverter::wordOrderToString(WordOrder order)
+{
+    switch (order) {
+    case WordOrder::ABCD: return "ABCD";
+    case WordOrder::CDAB: return "CDAB";
+    case WordOrder::BADC: return "BADC";
+    case WordOrder::DCBA: return "DCBA";
+    }
+    return "ABCD";
+}
+
 // ==================== 值到寄存器转换 ====================
 
 bool ModbusValueConverter::valueToRegisters(const QVariant &value, ModbusDataValueType type,
-                                             QVector<quint16> &registers)
+                                             QVector<quint16> &registers, WordOrder order)
 {
     registers.clear();
     int count = registerCount(type);
     registers.resize(count);
     
     bool ok = true;
+    quint16 *regs = registers.data();
     
     switch (type) {
     case ModbusDataValueType::BOOL:
-        boolToRegister(value.toBool(), registers[0]);
+        boolToRegister(value.toBool(), regs[0]);
         break;
     case ModbusDataValueType::INT8:
-        int8ToRegister(static_cast<qint8>(value.toInt(&ok)), registers[0]);
+        int8ToRegister(static_cast<qint8>(value.toInt(&ok)), regs[0]);
         break;
     case ModbusDataValueType::UINT8:
-        uint8ToRegister(static_cast<quint8>(value.toUInt(&ok)), registers[0]);
+        uint8ToRegister(static_cast<quint8>(value.toUInt(&ok)), regs[0]);
         break;
     case ModbusDataValueType::INT16:
-        int16ToRegister(static_cast<qint16>(value.toInt(&ok)), registers[0]);
+        encode<qint16>(static_cast<qint16>(value.toInt(&ok)), regs, order);
         break;
     case ModbusDataValueType::UINT16:
-        uint16ToRegister(static_cast<quint16>(value.toUInt(&ok)), registers[0]);
+        encode<quint16>(static_cast<quint16>(value.toUInt(&ok)), regs, order);
         break;
     case ModbusDataValueType::INT32:
-        int32ToRegisters(value.toInt(&ok), registers[0], registers[1]);
+        encode<qint32>(value.toInt(&ok), regs, order);
         break;
     case ModbusDataValueType::UINT32:
-        uint32ToRegisters(value.toUInt(&ok), registers[0], registers[1]);
+        encode<quint32>(value.toUInt(&ok), regs, order);
         break;
     case ModbusDataValueType::INT64:
-        int64ToRegisters(value.toLongLong(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<qint64>(value.toLongLong(&ok), regs, order);
         break;
     case ModbusDataValueType::UINT64:
-        uint64ToRegisters(value.toULongLong(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<quint64>(value.toULongLong(&ok), regs, order);
         break;
     case ModbusDataValueType::FLOAT32:
-        float32ToRegisters(value.toFloat(&ok), registers[0], registers[1]);
+        encode<float>(value.toFloat(&ok), regs, order);
         break;
     case ModbusDataValueType::FLOAT64:
-        float64ToRegisters(value.toDouble(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<double>(value.toDouble(&ok), regs, order);
         break;
     }
     
@@ -130,107 +181,144 @@ bool ModbusValueConverter::valueToRegisters(const QVariant &value, ModbusDataVal
 }
 
 bool ModbusValueConverter::stringToRegisters(const QString &valueStr, ModbusDataValueType type,
-                                              QVector<quint16> &registers)
+                                              QVector<quint16> &registers, WordOrder order)
 {
     registers.clear();
     int count = registerCount(type);
     registers.resize(count);
     
     bool ok = true;
+    quint16 *regs = registers.data();
     
     switch (type) {
     case ModbusDataValueType::BOOL: {
         QString lower = valueStr.toLower().trimmed();
         bool boolVal = (lower == "true" || lower == "1" || lower == "on" || lower == "是");
-        boolToRegister(boolVal, registers[0]);
+        boolToRegister(boolVal, regs[0]);
         break;
     }
     case ModbusDataValueType::INT8:
-        int8ToRegister(static_cast<qint8>(valueStr.toShort(&ok)), registers[0]);
+        int8ToRegister(static_cast<qint8>(valueStr.toShort(&ok)), regs[0]);
         break;
     case ModbusDataValueType::UINT8:
-        uint8ToRegister(static_cast<quint8>(valueStr.toUShort(&ok)), registers[0]);
+        uint8ToRegister(static_cast<quint8>(valueStr.toUShort(&ok)), regs[0]);
         break;
     case ModbusDataValueType::INT16:
-        int16ToRegister(valueStr.toShort(&ok), registers[0]);
+        encode<qint16>(valueStr.toShort(&ok), regs, order);
         break;
     case ModbusDataValueType::UINT16:
-        uint16ToRegister(valueStr.toUShort(&ok), registers[0]);
+        encode<quint16>(valueStr.toUShort(&ok), regs, order);
         break;
     case ModbusDataValueType::INT32:
-        int32ToRegisters(valueStr.toInt(&ok), registers[0], registers[1]);
+        encode<qint32>(valueStr.toInt(&ok), regs, order);
         break;
     case ModbusDataValueType::UINT32:
-        uint32ToRegisters(valueStr.toUInt(&ok), registers[0], registers[1]);
+        encode<quint32>(valueStr.toUInt(&ok), regs, order);
         break;
     case ModbusDataValueType::INT64:
-        int64ToRegisters(valueStr.toLongLong(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<qint64>(valueStr.toLongLong(&ok), regs, order);
         break;
     case ModbusDataValueType::UINT64:
-        uint64ToRegisters(valueStr.toULongLong(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<quint64>(valueStr.toULongLong(&ok), regs, order);
         break;
     case ModbusDataValueType::FLOAT32:
-        float32ToRegisters(valueStr.toFloat(&ok), registers[0], registers[1]);
+        encode<float>(valueStr.toFloat(&ok), regs, order);
         break;
     case ModbusDataValueType::FLOAT64:
-        float64ToRegisters(valueStr.toDouble(&ok), registers[0], registers[1], registers[2], registers[3]);
+        encode<double>(valueStr.toDouble(&ok), regs, order);
         break;
     }
     
     return ok;
 }
 
-// ==================== 寄存器到值转换 ====================
-
-QVariant ModbusValueConverter::registersToValue(const QVector<quint16> &registers, ModbusDataValueType type)
+void ModbusValueConverter::doubleToRegisters(double value, ModbusDataValueType type,
+                                              QVector<quint16> &registers, WordOrder order)
 {
-    if (registers.isEmpty()) {
-        return QVariant();
-    }
+    registers.clear();
+    registers.resize(registerCount(type));
+    quint16 *regs = registers.data();
     
     switch (type) {
     case ModbusDataValueType::BOOL:
-        return registerToBool(registers[0]);
+        boolToRegister(value != 0.0, regs[0]);
+        break;
     case ModbusDataValueType::INT8:
-        return registerToInt8(registers[0]);
+        int8ToRegister(roundToInteger<qint8>(value), regs[0]);
+        break;
     case ModbusDataValueType::UINT8:
-        return registerToUint8(registers[0]);
+        uint8ToRegister(roundToInteger<quint8>(value), regs[0]);
+        break;
     case ModbusDataValueType::INT16:
-        return registerToInt16(registers[0]);
+        encode<qint16>(roundToInteger<qint16>(value), regs, order);
+        break;
     case ModbusDataValueType::UINT16:
-        return registerToUint16(registers[0]);
+        encode<quint16>(roundToInteger<quint16>(value), regs, order);
+        break;
     case ModbusDataValueType::INT32:
-        if (registers.size() >= 2)
-            return registersToInt32(registers[0], registers[1]);
+        encode<qint32>(roundToInteger<qint32>(value), regs, order);
         break;
     case ModbusDataValueType::UINT32:
-        if (registers.size() >= 2)
-            return registersToUint32(registers[0], registers[1]);
+        encode<quint32>(roundToInteger<quint32>(value), regs, order);
         break;
     case ModbusDataValueType::INT64:
-        if (registers.size() >= 4)
-            return registersToInt64(registers[0], registers[1], registers[2], registers[3]);
+        encode<qint64>(roundToInteger<qint64>(value), regs, order);
         break;
     case ModbusDataValueType::UINT64:
-        if (registers.size() >= 4)
-            return registersToUint64(registers[0], registers[1], registers[2], registers[3]);
+        encode<quint64>(roundToInteger<quint64>(value), regs, order);
         break;
     case ModbusDataValueType::FLOAT32:
-        if (registers.size() >= 2)
-            return registersToFloat32(registers[0], registers[1]);
+        encode<float>(float(value), regs, order);
         break;
     case ModbusDataValueType::FLOAT64:
-        if (registers.size() >= 4)
-            return registersToFloat64(registers[0], registers[1], registers[2], registers[3]);
+        encode<double>(value, regs, order);
         break;
     }
+}
+
+// ==================== 寄存器到值转换 ====================
+
+QVariant ModbusValueConverter::registersToValue(const QVector<quint16> &registers, ModbusDataValueType type,
+                                                WordOrder order)
+{
+    if (registers.size() < registerCount(type)) {
+        return QVariant();
+    }
+    
+    const quint16 *regs = registers.constData();
+    
+    switch (type) {
+    case ModbusDataValueType::BOOL:
+        return registerToBool(regs[0]);
+    case ModbusDataValueType::INT8:
+        return registerToInt8(regs[0]);
+    case ModbusDataValueType::UINT8:
+        return registerToUint8(regs[0]);
+    case ModbusDataValueType::INT16:
+        return decode<qint16>(regs, order);
+    case ModbusDataValueType::UINT16:
+        return decode<quint16>(regs, order);
+    case ModbusDataValueType::INT32:
+        return decode<qint32>(regs, order);
+    case ModbusDataValueType::UINT32:
+        return decode<quint32>(regs, order);
+    case ModbusDataValueType::INT64:
+        return decode<qint64>(regs, order);
+    case ModbusDataValueType::UINT64:
+        return decode<quint64>(regs, order);
+    case ModbusDataValueType::FLOAT32:
+        return decode<float>(regs, order);
+    case ModbusDataValueType::FLOAT64:
+        return decode<double>(regs, order);
+    }
     
     return QVariant();
 }
 
-QString ModbusValueConverter::registersToString(const QVector<quint16> &registers, ModbusDataValueType type)
+QString ModbusValueConverter::registersToString(const QVector<quint16> &registers, ModbusDataValueType type,
+                                                WordOrder order)
 {
-    QVariant value = registersToValue(registers, type);
+    QVariant value = registersToValue(registers, type, order);
     
     if (!value.isValid()) {
         return QString();
@@ -4,6 +4,7 @@
  * 
  * 提供各种数据类型与 Modbus 寄存器之间的转换功能
  * 支持: BOOL, INT8, UINT8, INT16, UINT16, INT32, UINT32, INT64, UINT64, FLOAT32, FLOAT64
+ * 多寄存器值支持 ABCD/CDAB/BADC/DCBA 四种字节序，由 ModbusCodec 在编译期展开为移位/字节交换
  */
 
 #ifndef MODBUSVALUECONVERTER_H
@@ -13,7 +14,9 @@
 #include <QVector>
 #include <QString>
 #include <QVariant>
+#include <QtEndian>
 #include <cstring>
+#include <type_traits>
 
 /**
  * @brief 数据类型枚举
@@ -32,6 +35,73 @@ enum class ModbusDataValueType {
     FLOAT64     // 64位双精度浮点数 (需要4个寄存器)
 };
 
+/**
+ * @brief 多字节值在寄存器中的字节序
+ *
+ * 以 32 位值 0xAABBCCDD（A 为最高字节）为例，寄存器依次为：
+ * ABCD: 0xAABB 0xCCDD（高字在前，Modbus 默认）
+ * CDAB: 0xCCDD 0xAABB（低字在前）
+ * BADC: 0xBBAA 0xDDCC（字内字节交换）
+ * DCBA: 0xDDCC 0xBBAA（完全小端）
+ * 64 位值同理按 4 个字处理；BOOL/INT8/UINT8 只占寄存器低字节，不受字节序影响
+ */
+enum class WordOrder {
+    ABCD,
+    CDAB,
+    BADC,
+    DCBA
+};
+
+/**
+ * @brief 编译期特化的值编解码器
+ *
+ * T 为 16/32/64 位整数或浮点类型，Order 为字节序；循环次数和交换方式都是常量，
+ * 编译后只剩几次移位或一条 bswap，不经过 QVariant/QString
+ */
+template <typename T, WordOrder Order>
+struct ModbusCodec
+{
+    static_assert(sizeof(T) == 2 || sizeof(T) == 4 || sizeof(T) == 8, "ModbusCodec 只支持 16/32/64 位类型");
+
+    using Raw = std::conditional_t<sizeof(T) == 2, quint16,
+                std::conditional_t<sizeof(T) == 4, quint32, quint64>>;
+
+    static constexpr int Registers = int(sizeof(T) / 2);
+    static constexpr bool SwapWords = Order == WordOrder::CDAB || Order == WordOrder::DCBA;
+    static constexpr bool SwapBytes = Order == WordOrder::BADC || Order == WordOrder::DCBA;
+
+    static T decode(const quint16 *registers)
+    {
+        quint64 raw = 0;
+        for (int i = 0; i < Registers; ++i) {
+            quint16 word = registers[SwapWords ? Registers - 1 - i : i];
+            if constexpr (SwapBytes) {
+                word = qbswap(word);
+            }
+            raw = (raw << 16) | word;
+        }
+        const Raw bits = Raw(raw);
+        T value;
+        std::memcpy(&value, &bits, sizeof(T));
+        return value;
+    }
+
+    static void encode(T value, quint16 *registers)
+    {
+        Raw bits;
+        std::memcpy(&bits, &value, sizeof(T));
+        quint64 raw = bits;
+        for (int i = Registers - 1; i >= 0; --i) {
+            quint16 word = quint16(raw & 0xFFFF);
+            if constexpr (SwapBytes) {
+                word = qbswap(word);
+            }
+            registers[SwapWords ? Registers - 1 - i : i] = word;
+            raw >>= 16;
+        }
+    }
+};
+
 /**
  * @brief Modbus 值转换器 - 提供类型安全的值与寄存器转换
  * 
@@ -62,6 +132,52 @@ public:
      * @return 类型字符串
      */
     static QString typeToString(ModbusDataValueType type);
+
+    /**
+     * @brief 从字符串解析字节序
+     * @param orderStr 字节序字符串 (如 "CDAB", "1234", "小端")
+     * @return 对应的枚举值，默认返回 ABCD
+     */
+    static WordOrder parseWordOrder(const QString &orderStr);
+
+    /**
+     * @brief 将字节序转为字符串
+     * @param order 字节序枚举
+     * @return "ABCD"/"CDAB"/"BADC"/"DCBA"
+     */
+    static QString wordOrderToString(WordOrder order);
+
+    // ==================== 按运行时字节序编解码 ====================
+
+    /**
+     * @brief 按字节序从 registers 解码一个 T（只在入口处分派一次，内部为 ModbusCodec）
+     */
+    template <typename T>
+    static T decode(const quint16 *registers, WordOrder order)
+    {
+        switch (order) {
+        case WordOrder::CDAB: return ModbusCodec<T, WordOrder::CDAB>::decode(registers);
+        case WordOrder::BADC: return ModbusCodec<T, WordOrder::BADC>::decode(registers);
+        case WordOrder::DCBA: return ModbusCodec<T, WordOrder::DCBA>::decode(registers);
+        case WordOrder::ABCD: break;
+        }
+        return ModbusCodec<T, WordOrder::ABCD>::decode(registers);
+    }
+
+    /**
+     * @brief 按字节序把 value 编码到 registers（sizeof(T) / 2 个寄存器）
+     */
+    template <typename T>
+    static void encode(T value, quint16 *registers, WordOrder order)
+    {
+        switch (order) {
+        case WordOrder::CDAB: ModbusCodec<T, WordOrder::CDAB>::encode(value, registers); return;
+        case WordOrder::BADC: ModbusCodec<T, WordOrder::BADC>::encode(value, registers); return;
+        case WordOrder::DCBA: ModbusCodec<T, WordOrder::DCBA>::encode(value, registers); return;
+        case WordOrder::ABCD: break;
+        }
+        ModbusCodec<T, WordOrder::ABCD>::encode(value, registers);
+    }
     
     // ==================== 值到寄存器转换 ====================
     
@@ -70,20 +186,32 @@ public:
      * @param value 输入值
      * @param type 数据类型
      * @param registers 输出寄存器数组
+     * @param order 字节序
      * @return 转换是否成功
      */
     static bool valueToRegisters(const QVariant &value, ModbusDataValueType type, 
-                                  QVector<quint16> &registers);
+                                  QVector<quint16> &registers, WordOrder order = WordOrder::ABCD);
     
     /**
      * @brief 将字符串值转换为寄存器数组
      * @param valueStr 输入值字符串
      * @param type 数据类型
      * @param registers 输出寄存器数组
+     * @param order 字节序
      * @return 转换是否成功
      */
     static bool stringToRegisters(const QString &valueStr, ModbusDataValueType type,
-                                   QVector<quint16> &registers);
+                                   QVector<quint16> &registers, WordOrder order = WordOrder::ABCD);
+    
+    /**
+     * @brief 将浮点数值转换为寄存器数组（整数类型四舍五入并饱和到类型范围）
+     * @param value 输入值
+     * @param type 数据类型
+     * @param registers 输出寄存器数组
+     * @param order 字节序
+     */
+    static void doubleToRegisters(double value, ModbusDataValueType type,
+                                  QVector<quint16> &registers, WordOrder order = WordOrder::ABCD);
     
     // ==================== 寄存器到值转换 ====================
     
@@ -91,17 +219,21 @@ public:
      * @brief 将寄存器数组转换为 QVariant 值
      * @param registers 输入寄存器数组
      * @param type 数据类型
+     * @param order 字节序
      * @return 转换后的值
      */
-    static QVariant registersToValue(const QVector<quint16> &registers, ModbusDataValueType type);
+    static QVariant registersToValue(const QVector<quint16> &registers, ModbusDataValueType type,
+                                     WordOrder order = WordOrder::ABCD);
     
     /**
      * @brief 将寄存器数组转换为字符串
      * @param registers 输入寄存器数组
      * @param type 数据类型
+     * @param order 字节序
      * @return 值的字符串表示
      */
-    static QString registersToString(const QVector<quint16> &registers, ModbusDataValueType type);
+    static QString registersToString(const QVector<quint16> &registers, ModbusDataValueType type,
+                                     WordOrder order = WordOrder::ABCD);
     
     // ==================== 具体类型转换 - 值到寄存器 ====================
     
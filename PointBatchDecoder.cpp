@@ -0,0 +1,315 @@
+/**
+ * @file PointBatchDecoder.cpp
+ * @brief 点位批量解码器实现
+ */
+
+#include "PointBatchDecoder.h"
+#include "ModbusDataStore.h"
+#include <QHash>
+#include <limits>
+
+namespace {
+
+// 组内解码循环：类型和字节序都是模板参数，循环体只剩读取、移位和存储
+template <typename T, WordOrder Order, typename Out>
+void decodeRun(const quint16 *address, const int *output, int count, const quint16 *image, Out *out)
+{
+    for (int i = 0; i < count; ++i) {
+        out[output[i]] = Out(ModbusCodec<T, Order>::decode(image + address[i]));
+    }
+}
+
+template <typename T, typename Out>
+void decodeRun(WordOrder order, const quint16 *address, const int *output, int count,
+               const quint16 *image, Out *out)
+{
+    switch (order) {
+    case WordOrder::ABCD: decodeRun<T, WordOrder::ABCD>(address, output, count, image, out); break;
+    case WordOrder::CDAB: decodeRun<T, WordOrder::CDAB>(address, output, count, image, out); break;
+    case WordOrder::BADC: decodeRun<T, WordOrder::BADC>(address, output, count, image, out); break;
+    case WordOrder::DCBA: decodeRun<T, WordOrder::DCBA>(address, output, count, image, out); break;
+    }
+}
+
+// 按值类型分派到对应的解码循环（BOOL 由调用者处理）；
+// Out 为 qint64 时是原始整数列，为 double 时用于浮点列和需要换算的点位
+template <typename Out>
+void decodeValues(ModbusDataValueType type, WordOrder order, const quint16 *address, const int *output,
+                  int count, const quint16 *image, Out *out)
+{
+    switch (type) {
+    case ModbusDataValueType::BOOL:
+        break;
+    case ModbusDataValueType::INT8:
+        for (int i = 0; i < count; ++i) {
+            out[output[i]] = Out(qint8(image[address[i]] & 0xFF));
+        }
+        break;
+    case ModbusDataValueType::UINT8:
+        for (int i = 0; i < count; ++i) {
+            out[output[i]] = Out(quint8(image[address[i]] & 0xFF));
+        }
+        break;
+    case ModbusDataValueType::INT16:
+        decodeRun<qint16>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::UINT16:
+        decodeRun<quint16>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::INT32:
+        decodeRun<qint32>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::UINT32:
+        decodeRun<quint32>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::INT64:
+        decodeRun<qint64>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::UINT64:
+        decodeRun<quint64>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::FLOAT32:
+        decodeRun<float>(order, address, output, count, image, out);
+        break;
+    case ModbusDataValueType::FLOAT64:
+        decodeRun<double>(order, address, output, count, image, out);
+        break;
+    }
+}
+
+QString formatInteger(qint64 value, ModbusDataValueType type)
+{
+    if (type == ModbusDataValueType::UINT64) {
+        return QString::number(quint64(value));  // 按位存放在 int64 列中
+    }
+    return QString::number(value);
+}
+
+QString formatReal(double value, ModbusDataValueType type)
+{
+    return QString::number(value, 'g', type == ModbusDataValueType::FLOAT32 ? 7 : 15);
+}
+
+QString formatBool(bool value)
+{
+    return value ? QStringLiteral("1") : QStringLiteral("0");
+}
+
+} // namespace
+
+// ========== RegisterImage 实现 ==========
+
+RegisterImage::RegisterImage()
+    : coils(ADDRESS_SPACE, 0)
+    , discreteInputs(ADDRESS_SPACE, 0)
+    , holdingRegisters(ADDRESS_SPACE, 0)
+    , inputRegisters(ADDRESS_SPACE, 0)
+{
+}
+
+void RegisterImage::capture(const ModbusDataStore *dataStore)
+{
+    dataStore->snapshotCoils(coils.data());
+    dataStore->snapshotDiscreteInputs(discreteInputs.data());
+    dataStore->snapshotHoldingRegisters(holdingRegisters.data());
+    dataStore->snapshotInputRegisters(inputRegisters.data());
+}
+
+// ========== PointBatchDecoder 实现 ==========
+
+void PointBatchDecoder::setPoints(const QList<SensorItem> &points)
+{
+    m_groups.clear();
+    m_slots.clear();
+    m_slots.reserve(points.size());
+
+    int integerCount = 0;
+    int realCount = 0;
+    int boolCount = 0;
+    QHash<quint32, int> groupIndexes;
+
+    for (const SensorItem &item : points) {
+        Area area = HoldingArea;
+        ModbusDataValueType type = item.valueType();
+        WordOrder order = item.byteOrder();
+
+        switch (item.pointType()) {
+        case SensorPointType::Coil:
+            area = CoilArea;
+            type = ModbusDataValueType::BOOL;
+            break;
+        case SensorPointType::DiscreteInput:
+            area = DiscreteInputArea;
+            type = ModbusDataValueType::BOOL;
+            break;
+        case SensorPointType::HoldingRegister:
+            area = HoldingArea;
+            break;
+        case SensorPointType::InputRegister:
+            area = InputArea;
+            break;
+        }
+        if (ModbusValueConverter::registerCount(type) == 1 && type != ModbusDataValueType::INT16
+                && type != ModbusDataValueType::UINT16) {
+            order = WordOrder::ABCD;  // BOOL/INT8/UINT8 不受字节序影响，合并到同一组
+        }
+
+        // 需要换算的点位输出工程值，统一放在浮点列
+        const bool scaled = type != ModbusDataValueType::BOOL && item.hasTransform();
+
+        Slot slot;
+        slot.type = type;
+        if (!item.fitsAddressSpace()) {
+            // 越过 0xFFFF 的多寄存器点位不分组，显示为空
+            slot.column = IntegerColumn;
+            slot.index = -1;
+            m_slots.append(slot);
+            continue;
+        }
+        if (type == ModbusDataValueType::BOOL) {
+            slot.column = BoolColumn;
+            slot.index = boolCount++;
+        } else if (scaled || type == ModbusDataValueType::FLOAT32 || type == ModbusDataValueType::FLOAT64) {
+            slot.column = RealColumn;
+            slot.index = realCount++;
+        } else {
+            slot.column = IntegerColumn;
+            slot.index = integerCount++;
+        }
+        m_slots.append(slot);
+
+        const quint32 key = (quint32(scaled) << 24) | (quint32(area) << 16) | (quint32(type) << 8) | quint32(order);
+        auto it = groupIndexes.constFind(key);
+        if (it == groupIndexes.constEnd()) {
+            it = groupIndexes.insert(key, m_groups.size());
+            Group group;
+            group.area = area;
+            group.type = type;
+            group.order = order;
+            group.scaled = scaled;
+            m_groups.append(group);
+        }
+        Group &group = m_groups[it.value()];
+        group.addresses.append(item.address());
+        group.outputs.append(slot.index);
+        if (scaled) {
+            // 换算参数预先展开成数组；不限幅的点位用 ±无穷，循环内不需要判断
+            const double infinity = std::numeric_limits<double>::infinity();
+            group.scales.append(item.scale());
+            group.offsets.append(item.offset());
+            group.minLimits.append(item.isClamped() ? item.minLimit() : -infinity);
+            group.maxLimits.append(item.isClamped() ? item.maxLimit() : infinity);
+        }
+    }
+
+    m_integers.fill(0, integerCount);
+    m_reals.fill(0.0, realCount);
+    m_bools.fill(0, boolCount);
+}
+
+void PointBatchDecoder::decode(const RegisterImage &image)
+{
+    for (const Group &group : std::as_const(m_groups)) {
+        decodeGroup(group, image);
+    }
+}
+
+void PointBatchDecoder::decodeGroup(const Group &group, const RegisterImage &image)
+{
+    const quint16 *address = group.addresses.constData();
+    const int *output = group.outputs.constData();
+    const int count = group.addresses.size();
+
+    if (group.area == CoilArea || group.area == DiscreteInputArea) {
+        const quint8 *bits = (group.area == CoilArea ? image.coils : image.discreteInputs).constData();
+        quint8 *out = m_bools.data();
+        for (int i = 0; i < count; ++i) {
+            out[output[i]] = bits[address[i]];
+        }
+        return;
+    }
+
+    const quint16 *regs = (group.area == HoldingArea ? image.holdingRegisters : image.inputRegisters).constData();
+
+    if (group.type == ModbusDataValueType::BOOL) {
+        quint8 *out = m_bools.data();
+        for (int i = 0; i < count; ++i) {
+            out[output[i]] = regs[address[i]] != 0;
+        }
+        return;
+    }
+
+    if (group.scaled) {
+        // 先解码为原始值，再按预先展开的参数换算和限幅
+        double *reals = m_reals.data();
+        decodeValues(group.type, group.order, address, output, count, regs, reals);
+
+        const double *scale = group.scales.constData();
+        const double *offset = group.offsets.constData();
+        const double *minLimit = group.minLimits.constData();
+        const double *maxLimit = group.maxLimits.constData();
+        for (int i = 0; i < count; ++i) {
+            double &value = reals[output[i]];
+            value = qBound(minLimit[i], value * scale[i] + offset[i], maxLimit[i]);
+        }
+        return;
+    }
+
+    if (group.type == ModbusDataValueType::FLOAT32 || group.type == ModbusDataValueType::FLOAT64) {
+        decodeValues(group.type, group.order, address, output, count, regs, m_reals.data());
+    } else {
+        decodeValues(group.type, group.order, address, output, count, regs, m_integers.data());
+    }
+}
+
+QString PointBatchDecoder::displayValue(int point) const
+{
+    const Slot &slot = m_slots.at(point);
+    if (slot.index < 0) {
+        return QString();
+    }
+    switch (slot.column) {
+    case BoolColumn:
+        return formatBool(m_bools.at(slot.index));
+    case RealColumn:
+        return formatReal(m_reals.at(slot.index), slot.type);
+    case IntegerColumn:
+        break;
+    }
+    return formatInteger(m_integers.at(slot.index), slot.type);
+}
+
+QStringList PointBatchDecoder::displayValues() const
+{
+    QStringList values;
+    values.reserve(m_slots.size());
+    for (int point = 0; point < m_slots.size(); ++point) {
+        values.append(displayValue(point));
+    }
+    return values;
+}
+
+QString PointBatchDecoder::decodeDisplayValue(const SensorItem &item, const quint16 *registers)
+{
+    if (!item.fitsAddressSpace()) {
+        return QString();
+    }
+    if (item.pointType() == SensorPointType::Coil || item.pointType() == SensorPointType::DiscreteInput
+            || item.valueType() == ModbusDataValueType::BOOL) {
+        return formatBool(registers[0] != 0);
+    }
+
+    // 与批量解码走同一套循环，只是点数为 1
+    const ModbusDataValueType type = item.valueType();
+    const quint16 address = 0;
+    const int output = 0;
+    if (item.hasTransform() || type == ModbusDataValueType::FLOAT32 || type == ModbusDataValueType::FLOAT64) {
+        double value = 0.0;
+        decodeValues(type, item.byteOrder(), &address, &output, 1, registers, &value);
+        return formatReal(item.hasTransform() ? item.toEngineering(value) : value, type);
+    }
+
+    qint64 value = 0;
+    decodeValues(type, item.byteOrder(), &address, &output, 1, registers, &value);
+    return formatInteger(value, type);
+}
@@ -0,0 +1,106 @@
+/**
+ * @file PointBatchDecoder.h
+ * @brief 点位批量解码器头文件
+ *
+ * 点表设置后先按（数据区、值类型、字节序）分组编译成偏移数组，
+ * 之后每次刷新只需对寄存器快照做一遍按组的紧凑循环，
+ * 结果按类型写入 int64/double/bool 三列，64 位整数完全精确；
+ * 有工程量换算的点位在同一遍中按预先展开的比例/偏移/限值换算，输出到 double 列
+ */
+
+#ifndef POINTBATCHDECODER_H
+#define POINTBATCHDECODER_H
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include "SensorItem.h"
+
+class ModbusDataStore;
+
+// 四个数据区的整块快照，每区 65536 项；越过 0xFFFF 的多寄存器点位不参与解码（见 SensorItem::fitsAddressSpace）
+struct RegisterImage
+{
+    static constexpr int ADDRESS_SPACE = 65536;
+
+    RegisterImage();
+
+    // 从数据存储复制全部数据区
+    void capture(const ModbusDataStore *dataStore);
+
+    QVector<quint8> coils;
+    QVector<quint8> discreteInputs;
+    QVector<quint16> holdingRegisters;
+    QVector<quint16> inputRegisters;
+};
+
+// 点位批量解码器
+class PointBatchDecoder
+{
+public:
+    // 结果所在的列
+    enum Column : quint8 {
+        IntegerColumn,  // INT8 ~ INT64、UINT8 ~ UINT64（UINT64 按位存放）
+        RealColumn,     // FLOAT32、FLOAT64，以及有工程量换算的点位
+        BoolColumn      // 线圈、离散输入和 BOOL 类型寄存器
+    };
+
+    // 编译点表（点表变化时调用一次）
+    void setPoints(const QList<SensorItem> &points);
+    int pointCount() const { return m_slots.size(); }
+
+    // 一遍解码全部点位
+    void decode(const RegisterImage &image);
+
+    const QVector<qint64> &integers() const { return m_integers; }
+    const QVector<double> &reals() const { return m_reals; }
+    const QVector<quint8> &bools() const { return m_bools; }
+
+    // 第 point 个点位的列和列内下标；地址越界的点位下标为 -1
+    Column column(int point) const { return m_slots.at(point).column; }
+    int columnIndex(int point) const { return m_slots.at(point).index; }
+
+    // 显示用字符串（与点表顺序一致），地址越界的点位为空
+    QString displayValue(int point) const;
+    QStringList displayValues() const;
+
+    // 单个点位的显示值（格式和换算与批量结果一致）；registers 为点位起始处的寄存器，
+    // 线圈/离散输入为 0/1；地址越界的点位返回空
+    static QString decodeDisplayValue(const SensorItem &item, const quint16 *registers);
+
+private:
+    enum Area : quint8 { CoilArea, DiscreteInputArea, HoldingArea, InputArea };
+
+    // 同一数据区、类型、字节序和是否换算的点位，解码循环内没有分支
+    struct Group
+    {
+        Area area = HoldingArea;
+        ModbusDataValueType type = ModbusDataValueType::UINT16;
+        WordOrder order = WordOrder::ABCD;
+        bool scaled = false;
+        QVector<quint16> addresses;
+        QVector<int> outputs;       // 对应列内下标
+        QVector<double> scales;     // 以下仅 scaled 时有效，与 addresses 一一对应
+        QVector<double> offsets;
+        QVector<double> minLimits;
+        QVector<double> maxLimits;
+    };
+
+    struct Slot
+    {
+        Column column;
+        ModbusDataValueType type;
+        int index;
+    };
+
+    void decodeGroup(const Group &group, const RegisterImage &image);
+
+    QVector<Group> m_groups;
+    QVector<Slot> m_slots;
+    QVector<qint64> m_integers;
+    QVector<double> m_reals;
+    QVector<quint8> m_bools;
+};
+
+#endif // POINTBATCHDECODER_H
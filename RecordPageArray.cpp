@@ -0,0 +1,406 @@
+/**
+ * @file RecordPageArray.cpp
+ * @brief 分页的 16 位记录数组实现
+ */
+
+#include "RecordPageArray.h"
+#include <QDebug>
+#include <cstring>
+
+RecordPageArray::RecordPageArray(int recordCount)
+    : m_recordCount(qMax(0, recordCount))
+    , m_writtenCount(0)
+    , m_pages((m_recordCount + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE, nullptr)
+    , m_storage(nullptr)
+    , m_compression(false)
+    , m_cachePages(DEFAULT_CACHE_PAGES)
+{
+}
+
+RecordPageArray::~RecordPageArray()
+{
+    if (!m_storage) {
+        qDeleteAll(m_pages);
+    }
+    qDeleteAll(m_packedPages);
+}
+
+bool RecordPageArray::isWritten(int index) const
+{
+    if (index < 0 || index >= m_recordCount) {
+        return false;
+    }
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    const quint64 *written = writtenBits(index / RECORDS_PER_PAGE);
+    int offset = index % RECORDS_PER_PAGE;
+    return written && (written[offset / 64] >> (offset % 64)) & 1;
+}
+
+bool RecordPageArray::read(int start, int count, char *out) const
+{
+    // 按页拆分，每段一次 memcpy；未分配的页读出为 0
+    bool failed = false;
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    while (count > 0) {
+        int pageIndex = start / RECORDS_PER_PAGE;
+        int offset = start % RECORDS_PER_PAGE;
+        int chunk = qMin(count, RECORDS_PER_PAGE - offset);
+
+        const Page *page = m_compression ? touchPage(pageIndex, &failed) : m_pages.at(pageIndex);
+        if (page) {
+            std::memcpy(out, page->data + offset * 2, size_t(chunk) * 2);
+        } else {
+            std::memset(out, 0, size_t(chunk) * 2);
+        }
+
+        out += chunk * 2;
+        start += chunk;
+        count -= chunk;
+    }
+    return !failed;
+}
+
+bool RecordPageArray::write(int start, const char *data, int count)
+{
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    while (count > 0) {
+        int pageIndex = start / RECORDS_PER_PAGE;
+        int offset = start % RECORDS_PER_PAGE;
+        int chunk = qMin(count, RECORDS_PER_PAGE - offset);
+
+        Page *page = pageForWrite(pageIndex);
+        if (!page) {
+            return false;
+        }
+        std::memcpy(page->data + offset * 2, data, size_t(chunk) * 2);
+        markWritten(page, offset, chunk);
+        if (m_storage) {
+            m_dirtyPages.setBit(pageIndex);
+        }
+
+        data += chunk * 2;
+        start += chunk;
+        count -= chunk;
+    }
+    return true;
+}
+
+bool RecordPageArray::fill(int start, int count, quint16 value)
+{
+    const char hi = char(value >> 8);
+    const char lo = char(value & 0xFF);
+
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    while (count > 0) {
+        int pageIndex = start / RECORDS_PER_PAGE;
+        int offset = start % RECORDS_PER_PAGE;
+        int chunk = qMin(count, RECORDS_PER_PAGE - offset);
+
+        Page *page = pageForWrite(pageIndex);
+        if (!page) {
+            return false;
+        }
+        char *out = page->data + offset * 2;
+        if (hi == lo) {
+            std::memset(out, hi, size_t(chunk) * 2);
+        } else {
+            for (int i = 0; i < chunk; ++i) {
+                out[i * 2] = hi;
+                out[i * 2 + 1] = lo;
+            }
+        }
+        markWritten(page, offset, chunk);
+        if (m_storage) {
+            m_dirtyPages.setBit(pageIndex);
+        }
+
+        start += chunk;
+        count -= chunk;
+    }
+    return true;
+}
+
+QVector<int> RecordPageArray::writtenIndexes(int start, int maxCount) const
+{
+    QVector<int> indexes;
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    for (int pageIndex = qMax(0, start) / RECORDS_PER_PAGE;
+         pageIndex < m_pages.size() && indexes.size() < maxCount; ++pageIndex) {
+        // 压缩页直接用保留的位图，不解压
+        const quint64 *written = writtenBits(pageIndex);
+        if (!written) {
+            continue;  // 整页未写入
+        }
+
+        for (int word = 0; word < RECORDS_PER_PAGE / 64 && indexes.size() < maxCount; ++word) {
+            quint64 bits = written[word];
+            while (bits && indexes.size() < maxCount) {
+                int index = pageIndex * RECORDS_PER_PAGE + word * 64 + qCountTrailingZeroBits(bits);
+                if (index >= start) {
+                    indexes.append(index);
+                }
+                bits &= bits - 1;
+            }
+        }
+    }
+    return indexes;
+}
+
+qsizetype RecordPageArray::memoryUsage() const
+{
+    qsizetype bytes = m_pages.size() * qsizetype(sizeof(Page*)) + m_dirtyPages.size() / 8;
+    if (m_storage) {
+        return bytes;  // 页数据在外部存储中
+    }
+    QMutexLocker locker(m_compression ? &m_packMutex : nullptr);
+    for (const Page *page : m_pages) {
+        if (page) {
+            bytes += sizeof(Page);
+        }
+    }
+    bytes += m_packedPages.size() * qsizetype(sizeof(PackedPage*));
+    for (const PackedPage *packed : m_packedPages) {
+        if (packed) {
+            bytes += sizeof(PackedPage) + packed->data.size();
+        }
+    }
+    return bytes;
+}
+
+void RecordPageArray::setCompression(bool enabled, int cachePages)
+{
+    if (m_storage) {
+        return;  // 外部存储的页由操作系统按需换入换出
+    }
+
+    QMutexLocker locker(&m_packMutex);
+    m_cachePages = qMax(1, cachePages);
+    if (enabled) {
+        if (!m_compression) {
+            // 现有的页全部进入缓存，超出容量的随即压缩
+            m_packedPages.fill(nullptr, m_pages.size());
+            m_modifiedPages = QBitArray(int(m_pages.size()), true);
+            m_hotPages.clear();
+            for (int pageIndex = 0; pageIndex < m_pages.size(); ++pageIndex) {
+                if (m_pages.at(pageIndex)) {
+                    m_hotPages.prepend(pageIndex);
+                }
+            }
+            m_compression = true;
+        }
+        evictPages();
+        return;
+    }
+
+    if (!m_compression) {
+        return;
+    }
+    for (int pageIndex = 0; pageIndex < m_packedPages.size(); ++pageIndex) {
+        if (m_packedPages.at(pageIndex) && !m_pages.at(pageIndex)) {
+            if (!unpackPage(pageIndex)) {
+                // 丢弃压缩副本会丢数据：保持压缩，已解压的页交给缓存按需移出
+                evictPages();
+                return;
+            }
+            m_hotPages.append(pageIndex);
+        }
+    }
+    qDeleteAll(m_packedPages);
+    m_packedPages.clear();
+    m_modifiedPages.clear();
+    m_hotPages.clear();
+    m_compression = false;
+}
+
+void RecordPageArray::attach(char *storage)
+{
+    if (m_storage) {
+        return;
+    }
+    setCompression(false);
+
+    Page *pages = reinterpret_cast<Page*>(storage);
+    m_writtenCount = 0;
+    m_dirtyPages = QBitArray(int(m_pages.size()));
+    for (int pageIndex = 0; pageIndex < m_pages.size(); ++pageIndex) {
+        // 挂接前已在堆上写入的数据合并到外部存储
+        Page *heapPage = m_pages.at(pageIndex);
+        Page &page = pages[pageIndex];
+        if (heapPage) {
+            for (int word = 0; word < RECORDS_PER_PAGE / 64; ++word) {
+                quint64 bits = heapPage->written[word];
+                while (bits) {
+                    int offset = word * 64 + qCountTrailingZeroBits(bits);
+                    std::memcpy(page.data + offset * 2, heapPage->data + offset * 2, 2);
+                    bits &= bits - 1;
+                }
+                page.written[word] |= heapPage->written[word];
+            }
+            delete heapPage;
+            m_dirtyPages.setBit(pageIndex);
+        }
+
+        for (quint64 bits : page.written) {
+            m_writtenCount += qPopulationCount(bits);
+        }
+        m_pages[pageIndex] = &page;
+    }
+
+    m_storage = storage;
+}
+
+qsizetype RecordPageArray::storageSize(int recordCount)
+{
+    return pageStorageOffset((qMax(0, recordCount) + RECORDS_PER_PAGE - 1) / RECORDS_PER_PAGE);
+}
+
+qsizetype RecordPageArray::pageStorageOffset(int pageIndex)
+{
+    return qsizetype(pageIndex) * qsizetype(sizeof(Page));
+}
+
+QVector<int> RecordPageArray::takeDirtyPages()
+{
+    QVector<int> pages;
+    for (int i = 0; i < m_dirtyPages.size(); ++i) {
+        if (m_dirtyPages.testBit(i)) {
+            pages.append(i);
+        }
+    }
+    m_dirtyPages.fill(false);
+    return pages;
+}
+
+RecordPageArray::Page *RecordPageArray::pageForWrite(int pageIndex)
+{
+    if (m_compression) {
+        bool failed = false;
+        Page *page = touchPage(pageIndex, &failed);
+        if (failed) {
+            return nullptr;
+        }
+        if (!page) {
+            page = new Page;
+            std::memset(page, 0, sizeof(Page));
+            m_pages[pageIndex] = page;
+            m_hotPages.prepend(pageIndex);
+            evictPages();
+        }
+        m_modifiedPages.setBit(pageIndex);  // 压缩副本（如有）从此过期
+        return page;
+    }
+
+    Page *&page = m_pages[pageIndex];
+    if (!page) {
+        page = new Page;
+        std::memset(page, 0, sizeof(Page));
+    }
+    return page;
+}
+
+RecordPageArray::Page *RecordPageArray::touchPage(int pageIndex, bool *failed) const
+{
+    Page *page = m_pages.at(pageIndex);
+    if (page) {
+        // 命中缓存：移到最前（缓存只有几页，线性查找即可）
+        if (m_hotPages.isEmpty() || m_hotPages.first() != pageIndex) {
+            m_hotPages.removeOne(pageIndex);
+            m_hotPages.prepend(pageIndex);
+            evictPages();
+        }
+        return page;
+    }
+
+    if (!m_packedPages.at(pageIndex)) {
+        return nullptr;  // 整页未写入
+    }
+
+    page = unpackPage(pageIndex);
+    if (!page) {
+        *failed = true;
+        return nullptr;
+    }
+    m_modifiedPages.clearBit(pageIndex);
+    m_hotPages.prepend(pageIndex);
+    evictPages();
+    return page;
+}
+
+RecordPageArray::Page *RecordPageArray::unpackPage(int pageIndex) const
+{
+    PackedPage *packed = m_packedPages.at(pageIndex);
+    const QByteArray data = qUncompress(packed->data);
+    if (data.size() != PAGE_BYTES) {
+        qWarning() << "记录页解压失败，页号:" << pageIndex << "解压后字节数:" << data.size();
+        return nullptr;
+    }
+    Page *page = new Page;
+    std::memcpy(page->written, packed->written, sizeof(page->written));
+    std::memcpy(page->data, data.constData(), PAGE_BYTES);
+    m_pages[pageIndex] = page;
+    return page;
+}
+
+void RecordPageArray::evictPages() const
+{
+    while (m_hotPages.size() > m_cachePages) {
+        const int pageIndex = m_hotPages.takeLast();
+        Page *page = m_pages.at(pageIndex);
+
+        // 只读过的页：压缩副本仍然有效，丢弃解压副本即可；没有副本说明压缩不划算，保持原样
+        if (!m_modifiedPages.testBit(pageIndex)) {
+            if (m_packedPages.at(pageIndex)) {
+                m_pages[pageIndex] = nullptr;
+                delete page;
+            }
+            continue;
+        }
+
+        m_modifiedPages.clearBit(pageIndex);
+        delete m_packedPages.at(pageIndex);
+        m_packedPages[pageIndex] = nullptr;
+
+        QByteArray data = qCompress(reinterpret_cast<const uchar*>(page->data), PAGE_BYTES);
+        if (data.size() + qsizetype(sizeof(PackedPage)) >= qsizetype(sizeof(Page))) {
+            continue;  // 压缩不划算，保持原样（下次访问时重新进入缓存）
+        }
+
+        PackedPage *packed = new PackedPage;
+        data.squeeze();
+        packed->data = data;
+        std::memcpy(packed->written, page->written, sizeof(packed->written));
+        m_packedPages[pageIndex] = packed;
+        m_pages[pageIndex] = nullptr;
+        delete page;
+    }
+}
+
+// 按 64 位字置位已写入位图，并累计新写入的记录数
+void RecordPageArray::markWritten(Page *page, int offset, int count)
+{
+    while (count > 0) {
+        const int word = offset / 64;
+        const int bit = offset % 64;
+        const int bits = qMin(count, 64 - bit);
+        const quint64 mask = (bits == 64 ? ~quint64(0) : ((quint64(1) << bits) - 1)) << bit;
+
+        m_writtenCount += qPopulationCount(mask & ~page->written[word]);
+        page->written[word] |= mask;
+
+        offset += bits;
+        count -= bits;
+    }
+}
+
+const quint64 *RecordPageArray::writtenBits(int pageIndex) const
+{
+    if (const Page *page = m_pages.at(pageIndex)) {
+        return page->written;
+    }
+    if (m_compression) {
+        if (const PackedPage *packed = m_packedPages.at(pageIndex)) {
+            return packed->written;
+        }
+    }
+    return nullptr;
+}
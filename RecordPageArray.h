@@ -0,0 +1,109 @@
+/**
+ * @file RecordPageArray.h
+ * @brief 分页的 16 位记录数组头文件
+ *
+ * 记录按 Modbus 线上字节序（大端）连续存放，读写都是按页的 memcpy；
+ * 页在首次写入时才分配，未写入的记录读出为 0，并用位图记录哪些记录被写过；
+ * 也可以挂接到外部连续存储（如内存映射文件），此时记录写过的脏页供后台刷盘；
+ * 堆存储时可启用页压缩：最近访问的若干页保持解压（LRU），其余页压缩保存；
+ * 解压的页保留压缩副本，只读过的页移出缓存时直接丢弃解压副本，写过的页才重新压缩
+ */
+
+#ifndef RECORDPAGEARRAY_H
+#define RECORDPAGEARRAY_H
+
+#include <QBitArray>
+#include <QByteArray>
+#include <QList>
+#include <QMutex>
+#include <QVector>
+#include <QtGlobal>
+
+// 分页的 16 位记录数组（非线程安全，由使用者加锁；
+// 启用压缩后 const 读取也会更新页缓存，内部另有互斥锁，可在读锁下并发读取）
+class RecordPageArray
+{
+public:
+    static constexpr int RECORDS_PER_PAGE = 256;                     // 每页记录数
+    static constexpr int PAGE_BYTES = RECORDS_PER_PAGE * 2;          // 每页数据字节数
+    static constexpr int DEFAULT_CACHE_PAGES = 8;                    // 压缩时默认保持解压的页数
+
+    explicit RecordPageArray(int recordCount = 0);
+    ~RecordPageArray();
+
+    int size() const { return m_recordCount; }
+    int writtenCount() const { return m_writtenCount; }
+    bool isWritten(int index) const;
+
+    // 读取 count 条记录（每条 2 字节，大端）到 out，调用者保证范围合法；
+    // 压缩页解压失败时对应记录读出为 0 并返回 false
+    bool read(int start, int count, char *out) const;
+    // 写入 count 条记录，未分配的页按需分配；压缩页解压失败时停在该页并返回 false
+    bool write(int start, const char *data, int count);
+    // 把 count 条记录都写为 value（主机字节序），失败同 write
+    bool fill(int start, int count, quint16 value);
+
+    // 按记录号顺序返回从 start 开始的最多 maxCount 个已写入记录号
+    QVector<int> writtenIndexes(int start, int maxCount) const;
+
+    // 实际占用的堆内存（字节）
+    qsizetype memoryUsage() const;
+
+    // 页压缩（仅堆存储）：最近访问的 cachePages 页保持解压，被挤出缓存的页压缩保存，
+    // 压缩后不更小的页保持原样；关闭时全部解压，有页解压失败则保持压缩
+    void setCompression(bool enabled, int cachePages = DEFAULT_CACHE_PAGES);
+    bool isCompressed() const { return m_compression; }
+
+    // 改用外部存储（storageSize() 字节，8 字节对齐），已有数据拷贝过去，已写入位图从存储中恢复；
+    // 挂接后页压缩关闭
+    void attach(char *storage);
+    bool isAttached() const { return m_storage != nullptr; }
+    static qsizetype storageSize(int recordCount);
+    static qsizetype pageStorageOffset(int pageIndex);
+
+    // 取出并清空自上次调用以来写过的页号（仅外部存储时记录）
+    QVector<int> takeDirtyPages();
+
+private:
+    Q_DISABLE_COPY(RecordPageArray)
+
+    struct Page
+    {
+        char data[PAGE_BYTES];
+        quint64 written[RECORDS_PER_PAGE / 64];  // 已写入位图
+    };
+
+    // 压缩保存的页：数据用 qCompress 压缩，已写入位图保持原样以便不解压就能枚举
+    struct PackedPage
+    {
+        QByteArray data;
+        quint64 written[RECORDS_PER_PAGE / 64];
+    };
+
+    // 解压失败时返回 nullptr
+    Page *pageForWrite(int pageIndex);
+    void markWritten(Page *page, int offset, int count);
+    // 压缩时取页（解压并移到缓存最前），调用者持有 m_packMutex；
+    // 未写入的页返回 nullptr，解压失败时也返回 nullptr 并置 *failed
+    Page *touchPage(int pageIndex, bool *failed) const;
+    // 解压到 m_pages，压缩副本保留；失败时输出警告并返回 nullptr，压缩副本不动
+    Page *unpackPage(int pageIndex) const;
+    void evictPages() const;
+    const quint64 *writtenBits(int pageIndex) const;
+
+    int m_recordCount;
+    int m_writtenCount;
+    mutable QVector<Page*> m_pages;         // 未分配或已压缩的页为 nullptr
+    char *m_storage;                        // 外部存储，为空时页在堆上分配
+    QBitArray m_dirtyPages;
+
+    // 页压缩
+    bool m_compression;
+    int m_cachePages;
+    mutable QVector<PackedPage*> m_packedPages;  // 没有压缩副本的页为 nullptr
+    mutable QList<int> m_hotPages;               // 解压的页号，最近访问的在前
+    mutable QBitArray m_modifiedPages;           // 上次压缩后写过的页，移出缓存时需要重新压缩
+    mutable QMutex m_packMutex;
+};
+
+#endif // RECORDPAGEARRAY_H
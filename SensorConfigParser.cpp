@@ -11,11 +11,17 @@
 #include <QJsonObject>
 #include <QUrl>
 #include <QFileInfo>
+#include <QVarLengthArray>
+#include <QThread>
+#include <QThreadPool>
 #include <QDebug>
+#include <climits>
+#include <cstring>
 
 SensorConfigParser::SensorConfigParser(QObject *parent)
     : QObject(parent)
     , m_errorLine(0)
+    , m_parseThreads(0)
 {
 }
 
@@ -29,32 +35,51 @@ QList<SensorItem> SensorConfigParser::importFromFile(const QString &filePath, Co
     QString localPath = normalizeFilePath(filePath);
     
     QFile file(localPath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
         m_lastError = QString("无法打开文件: %1").arg(file.errorString());
         emit parseError(m_lastError, 0);
         return {};
     }
     
-    QTextStream in(&file);
-    in.setEncoding(QStringConverter::Utf8);
-    QString content = in.readAll();
-    file.close();
-    
     // 自动检测格式
     if (format == ConfigFormat::Auto) {
         format = detectFormat(localPath);
     }
     
-    return parseContent(content, format);
+    if (format == ConfigFormat::JSON) {
+        return parseJson(QString::fromUtf8(file.readAll()));
+    }
+    
+    // TSV/CSV：映射整个文件，直接在映射内存上切分；无法映射时（如特殊文件系统）退回一次性读取
+    const qint64 size = file.size();
+    uchar *mapped = size > 0 ? file.map(0, size) : nullptr;
+    QByteArray buffer;
+    QByteArrayView content;
+    if (mapped) {
+        content = QByteArrayView(mapped, size);
+    } else {
+        buffer = file.readAll();
+        content = buffer;
+    }
+    
+    QList<SensorItem> sensors = parseTsvCsv(content, format == ConfigFormat::CSV ? ',' : '\t');
+    
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    return sensors;
 }
 
 QList<SensorItem> SensorConfigParser::parseContent(const QString &content, ConfigFormat format)
 {
+    m_lastError.clear();
+    m_errorLine = 0;
+    
     switch (format) {
     case ConfigFormat::TSV:
-        return parseTsvCsv(content, QLatin1Char('\t'));
+        return parseTsvCsv(content.toUtf8(), '\t');
     case ConfigFormat::CSV:
-        return parseTsvCsv(content, QLatin1Char(','));
+        return parseTsvCsv(content.toUtf8(), ',');
     case ConfigFormat::JSON:
         return parseJson(content);
     case ConfigFormat::Auto:
@@ -62,9 +87,9 @@ QList<SensorItem> SensorConfigParser::parseContent(const QString &content, Confi
         if (content.trimmed().startsWith(QLatin1Char('['))) {
             return parseJson(content);
         } else if (content.contains(QLatin1Char('\t'))) {
-            return parseTsvCsv(content, QLatin1Char('\t'));
+            return parseTsvCsv(content.toUtf8(), '\t');
         } else {
-            return parseTsvCsv(content, QLatin1Char(','));
+            return parseTsvCsv(content.toUtf8(), ',');
         }
     }
     return {};
@@ -140,57 +165,195 @@ QString SensorConfigParser::normalizeFilePath(const QString &path) const
     return localPath;
 }
 
+void SensorConfigParser::reportProgress(qint64 current, qint64 total, bool force)
+{
+    if (!force && m_progressTimer.isValid() && m_progressTimer.elapsed() < PROGRESS_INTERVAL_MS) {
+        return;
+    }
+    m_progressTimer.start();
+    
+    // 超过 int 范围时按千分比报告
+    if (total > INT_MAX) {
+        current = current * 1000 / total;
+        total = 1000;
+    }
+    emit parseProgress(int(current), int(total));
+}
+
 // ==================== TSV/CSV 解析 ====================
 
-QList<SensorItem> SensorConfigParser::parseTsvCsv(const QString &content, QChar separator)
+QList<SensorItem> SensorConfigParser::parseTsvCsv(QByteArrayView content, char separator)
 {
+    // 跳过 UTF-8 BOM
+    if (content.startsWith("\xEF\xBB\xBF")) {
+        content = content.sliced(3);
+    }
+    
+    const qsizetype size = content.size();
+    const int threads = m_parseThreads > 0 ? m_parseThreads : QThread::idealThreadCount();
+    int chunkCount = 1;
+    if (threads > 1 && size >= PARALLEL_MIN_BYTES) {
+        chunkCount = int(qMin<qsizetype>(qsizetype(threads) * CHUNKS_PER_THREAD, size / MIN_CHUNK_BYTES));
+    }
+    
+    QVector<TsvCsvChunk> chunks = splitTsvCsv(content, chunkCount);
+    std::atomic<qint64> processed(0);
+    m_progressTimer.invalidate();
+    
+    if (chunks.size() <= 1) {
+        for (TsvCsvChunk &chunk : chunks) {
+            parseTsvCsvChunk(chunk, separator, processed, size, true);
+        }
+    } else {
+        // 各块互不依赖，主线程只负责按间隔报告进度
+        QThreadPool pool;
+        pool.setMaxThreadCount(threads);
+        for (TsvCsvChunk &chunk : chunks) {
+            pool.start([this, &chunk, separator, &processed, size]() {
+                parseTsvCsvChunk(chunk, separator, processed, size, false);
+            });
+        }
+        while (!pool.waitForDone(PROGRESS_INTERVAL_MS)) {
+            reportProgress(processed.load(std::memory_order_relaxed), size, true);
+        }
+    }
+    
+    // 按原顺序合并；整个内容中第一个像标题的行才是标题，跳过它的解析结果
+    int headerChunk = -1;
+    qsizetype itemCount = 0;
+    for (int i = 0; i < chunks.size(); ++i) {
+        if (headerChunk < 0 && chunks[i].headerLine > 0) {
+            headerChunk = i;
+        }
+        itemCount += chunks[i].items.size();
+    }
+    
     QList<SensorItem> sensors;
-    QStringList lines = content.split(QLatin1Char('\n'));
+    sensors.reserve(itemCount);
+    int lineOffset = 0;
+    for (int i = 0; i < chunks.size(); ++i) {
+        TsvCsvChunk &chunk = chunks[i];
+        const int skipLine = i == headerChunk ? chunk.headerLine : 0;
+        
+        for (int j = 0; j < chunk.items.size(); ++j) {
+            if (chunk.itemLines[j] != skipLine) {
+                sensors.append(std::move(chunk.items[j]));
+            }
+        }
+        for (int line : std::as_const(chunk.failedLines)) {
+            if (line == skipLine) {
+                continue;
+            }
+            const int lineNumber = lineOffset + line;
+            qDebug() << "[ConfigParser] 解析第" << lineNumber << "行失败";
+            if (m_errorLine == 0) {
+                m_errorLine = lineNumber;
+                m_lastError = QString("第 %1 行解析失败").arg(lineNumber);
+            }
+        }
+        lineOffset += chunk.lineCount;
+    }
     
-    bool headerSkipped = false;
+    reportProgress(size, size, true);
+    qDebug() << "[ConfigParser] 成功解析" << sensors.count() << "个传感器配置";
+    return sensors;
+}
+
+QVector<SensorConfigParser::TsvCsvChunk> SensorConfigParser::splitTsvCsv(QByteArrayView content, int chunkCount) const
+{
+    QVector<TsvCsvChunk> chunks;
+    const char *data = content.data();
+    const qsizetype size = content.size();
+    qsizetype start = 0;
+    
+    for (int i = 1; i <= chunkCount && start < size; ++i) {
+        qsizetype end = size;
+        if (i < chunkCount) {
+            // 从目标位置向后找到行尾，块总是以完整的行结束
+            const qsizetype target = qMax(start, size / chunkCount * i);
+            const char *lineEnd = static_cast<const char*>(std::memchr(data + target, '\n', size_t(size - target)));
+            end = lineEnd ? lineEnd - data + 1 : size;
+        }
+        TsvCsvChunk chunk;
+        chunk.content = content.sliced(start, end - start);
+        chunks.append(chunk);
+        start = end;
+    }
+    return chunks;
+}
+
+void SensorConfigParser::parseTsvCsvChunk(TsvCsvChunk &chunk, char separator, std::atomic<qint64> &processed,
+                                          qint64 total, bool reportDirectly)
+{
+    const char *data = chunk.content.data();
+    const qsizetype size = chunk.content.size();
+    qsizetype pos = 0;
+    qsizetype counted = 0;     // 已计入 processed 的字节数
     int lineNumber = 0;
     
-    for (const QString &rawLine : lines) {
+    while (pos < size) {
+        // 定位本行，行和字段都是指向原内容的视图
+        const char *lineEnd = static_cast<const char*>(std::memchr(data + pos, '\n', size_t(size - pos)));
+        const qsizetype end = lineEnd ? lineEnd - data : size;
+        const QByteArrayView line = QByteArrayView(data + pos, end - pos).trimmed();
+        pos = end + 1;
         lineNumber++;
-        QString line = rawLine.trimmed();
+        
+        // 每 1024 行累计一次已处理字节数
+        if ((lineNumber & 1023) == 0) {
+            const qsizetype done = qMin(pos, size);
+            const qint64 current = processed.fetch_add(done - counted, std::memory_order_relaxed) + (done - counted);
+            counted = done;
+            if (reportDirectly) {
+                reportProgress(current, total);
+            }
+        }
         
         // 跳过空行
         if (line.isEmpty()) {
             continue;
         }
         
-        // 跳过标题行
-        if (!headerSkipped) {
+        // 标题候选行照常解析，由合并阶段决定是否丢弃
+        if (chunk.headerLine == 0) {
             if (line.contains("地址") || line.contains("点位名称") || 
                 line.contains("寄存器类型") || line.contains("Address")) {
-                headerSkipped = true;
-                continue;
+                chunk.headerLine = lineNumber;
             }
         }
         
-        QStringList fields = line.split(separator);
+        QVarLengthArray<QByteArrayView, MAX_FIELDS> fields;
+        qsizetype fieldStart = 0;
+        while (fields.size() < MAX_FIELDS) {
+            const qsizetype sep = line.indexOf(separator, fieldStart);
+            if (sep < 0) {
+                fields.append(line.sliced(fieldStart));
+                break;
+            }
+            fields.append(line.sliced(fieldStart, sep - fieldStart));
+            fieldStart = sep + 1;
+        }
         
-        if (fields.count() < 4) {
+        if (fields.size() < 4) {
             continue; // 跳过字段不足的行
         }
         
         SensorItem item;
-        if (parseTsvCsvRow(fields, item)) {
-            sensors.append(item);
+        if (parseTsvCsvRow(fields.constData(), int(fields.size()), item)) {
+            chunk.items.append(item);
+            chunk.itemLines.append(lineNumber);
         } else {
-            qDebug() << "[ConfigParser] 解析第" << lineNumber << "行失败";
+            chunk.failedLines.append(lineNumber);
         }
-        
-        emit parseProgress(lineNumber, lines.count());
     }
     
-    qDebug() << "[ConfigParser] 成功解析" << sensors.count() << "个传感器配置";
-    return sensors;
+    chunk.lineCount = lineNumber;
+    processed.fetch_add(size - counted, std::memory_order_relaxed);
 }
 
-bool SensorConfigParser::parseTsvCsvRow(const QStringList &fields, SensorItem &item)
+bool SensorConfigParser::parseTsvCsvRow(const QByteArrayView *fields, int fieldCount, SensorItem &item)
 {
-    if (fields.count() < 4) {
+    if (fieldCount < 4) {
         return false;
     }
     
@@ -200,37 +363,37 @@ bool SensorConfigParser::parseTsvCsvRow(const QStringList &fields, SensorItem &i
     item.setAddress(fields[idx++].trimmed().toUShort());
     
     // 第2列：点位名称
-    item.setName(fields[idx++].trimmed());
+    item.setName(QString::fromUtf8(fields[idx++].trimmed()));
     
     // 第3列：寄存器类型
-    item.setPointType(SensorItem::parsePointType(fields[idx++].trimmed()));
+    item.setPointType(SensorItem::parsePointType(QString::fromUtf8(fields[idx++].trimmed())));
     
     // 第4列：初始值
-    item.setInitialValue(fields[idx++].trimmed());
+    item.setInitialValue(QString::fromUtf8(fields[idx++].trimmed()));
     
     // 第5列：描述 (可选)
-    if (idx < fields.count()) {
-        item.setDescription(fields[idx++].trimmed());
+    if (idx < fieldCount) {
+        item.setDescription(QString::fromUtf8(fields[idx++].trimmed()));
     }
     
     // 第6列：单位 (可选)
-    if (idx < fields.count()) {
-        item.setUnit(fields[idx++].trimmed());
+    if (idx < fieldCount) {
+        item.setUnit(QString::fromUtf8(fields[idx++].trimmed()));
     }
     
     // 第7列：最小值 (可选)
-    if (idx < fields.count()) {
-        item.setMinValue(fields[idx++].trimmed());
+    if (idx < fieldCount) {
+        item.setMinValue(QString::fromUtf8(fields[idx++].trimmed()));
     }
     
     // 第8列：最大值 (可选)
-    if (idx < fields.count()) {
-        item.setMaxValue(fields[idx++].trimmed());
+    if (idx < fieldCount) {
+        item.setMaxValue(QString::fromUtf8(fields[idx++].trimmed()));
     }
     
     // 第9列：只读 (可选)
-    if (idx < fields.count()) {
-        QString readOnlyStr = fields[idx++].trimmed();
+    if (idx < fieldCount) {
+        QByteArrayView readOnlyStr = fields[idx++].trimmed();
         bool isReadOnly = false;
         if (readOnlyStr == "是" || readOnlyStr == "true" || readOnlyStr == "1"){
             isReadOnly = true;
@@ -249,8 +412,8 @@ bool SensorConfigParser::parseTsvCsvRow(const QStringList &fields, SensorItem &i
     }
     
     // 第10列：值类型 (可选)
-    if (idx < fields.count()) {
-        QString valueTypeStr = fields[idx++].trimmed().toUpper();
+    if (idx < fieldCount) {
+        QString valueTypeStr = QString::fromUtf8(fields[idx++].trimmed()).toUpper();
         item.setValueType(ModbusValueConverter::parseTypeString(valueTypeStr));
     } else {
         // 根据点类型和初始值自动推断
@@ -265,8 +428,8 @@ bool SensorConfigParser::parseTsvCsvRow(const QStringList &fields, SensorItem &i
     }
     
     // 第11列：占用寄存器数 (可选，会覆盖自动计算的值)
-    if (idx < fields.count()) {
-        QString regCountStr = fields[idx++].trimmed();
+    if (idx < fieldCount) {
+        QByteArrayView regCountStr = fields[idx++].trimmed();
         if (!regCountStr.isEmpty()) {
             int regCount = regCountStr.toInt();
             if (regCount > 0) {
@@ -275,6 +438,35 @@ bool SensorConfigParser::parseTsvCsvRow(const QStringList &fields, SensorItem &i
         }
     }
     
+    // 第12列：字节序 (可选，ABCD/CDAB/BADC/DCBA，默认 ABCD)
+    if (idx < fieldCount) {
+        item.setByteOrder(ModbusValueConverter::parseWordOrder(QString::fromUtf8(fields[idx++])));
+    }
+    
+    // 第13列：比例系数 (可选，默认 1)
+    if (idx < fieldCount) {
+        bool ok = false;
+        double scale = fields[idx++].trimmed().toDouble(&ok);
+        if (ok) {
+            item.setScale(scale);
+        }
+    }
+    
+    // 第14列：偏移量 (可选，默认 0)
+    if (idx < fieldCount) {
+        bool ok = false;
+        double offset = fields[idx++].trimmed().toDouble(&ok);
+        if (ok) {
+            item.setOffset(offset);
+        }
+    }
+    
+    // 第15列：限幅 (可选，是/否，按最小值/最大值限制工程值)
+    if (idx < fieldCount) {
+        QByteArrayView clampStr = fields[idx++].trimmed();
+        item.setClamped(clampStr == "是" || clampStr == "true" || clampStr == "1");
+    }
+    
     return item.isValid();
 }
 
@@ -301,6 +493,7 @@ QList<SensorItem> SensorConfigParser::parseJson(const QString &content)
     
     QJsonArray array = doc.array();
     int index = 0;
+    m_progressTimer.invalidate();
     
     for (const QJsonValue &value : array) {
         if (!value.isObject()) {
@@ -315,9 +508,10 @@ QList<SensorItem> SensorConfigParser::parseJson(const QString &content)
             sensors.append(item);
         }
         
-        emit parseProgress(++index, array.count());
+        reportProgress(++index, array.count());
     }
     
+    reportProgress(array.count(), array.count(), true);
     qDebug() << "[ConfigParser] 成功解析" << sensors.count() << "个传感器配置 (JSON)";
     return sensors;
 }
@@ -340,7 +534,11 @@ QString SensorConfigParser::generateTsvCsv(const QList<SensorItem> &sensors, QCh
         << "最大值" << separator
         << "只读" << separator
         << "值类型" << separator
-        << "占用寄存器数" << "\n";
+        << "占用寄存器数" << separator
+        << "字节序" << separator
+        << "比例系数" << separator
+        << "偏移量" << separator
+        << "限幅" << "\n";
     
     // 写入数据行
     for (const SensorItem &item : sensors) {
@@ -354,7 +552,11 @@ QString SensorConfigParser::generateTsvCsv(const QList<SensorItem> &sensors, QCh
             << item.maxValue() << separator
             << (item.isReadOnly() ? "是" : "否") << separator
             << item.valueTypeString() << separator
-            << item.registerCount() << "\n";
+            << item.registerCount() << separator
+            << item.byteOrderString() << separator
+            << QString::number(item.scale(), 'g', 15) << separator
+            << QString::number(item.offset(), 'g', 15) << separator
+            << (item.isClamped() ? "是" : "否") << "\n";
     }
     
     return content;
@@ -2,7 +2,10 @@
  * @file SensorConfigParser.h
  * @brief 传感器配置解析器
  * 
- * 支持从多种格式（TSV/CSV/JSON）解析传感器配置
+ * 支持从多种格式（TSV/CSV/JSON）解析传感器配置；
+ * TSV/CSV 文件以内存映射方式读取，按 UTF-8 字节原地切分行和字段，
+ * 只有写入 SensorItem 的字段才转换为 QString，内存占用接近文件大小；
+ * 较大的内容按行边界切块，在线程池中并行解析后按原顺序合并，行号与顺序解析一致
  */
 
 #ifndef SENSORCONFIGPARSER_H
@@ -12,6 +15,10 @@
 #include <QString>
 #include <QList>
 #include <QStringList>
+#include <QByteArrayView>
+#include <QElapsedTimer>
+#include <QVector>
+#include <atomic>
 #include "SensorItem.h"
 
 /**
@@ -75,22 +82,56 @@ public:
      */
     QString generateContent(const QList<SensorItem> &sensors, ConfigFormat format);
     
+    // ==================== 解析选项 ====================
+    
+    /**
+     * @brief 设置 TSV/CSV 并行解析的线程数
+     * @param count 0 表示按 CPU 核数，1 表示顺序解析
+     */
+    void setParseThreadCount(int count) { m_parseThreads = qMax(0, count); }
+    int parseThreadCount() const { return m_parseThreads; }
+    
     // ==================== 错误信息 ====================
     
     QString lastError() const { return m_lastError; }
-    int errorLine() const { return m_errorLine; }
+    int errorLine() const { return m_errorLine; }    // 第一个解析失败的行号，0 表示没有
     
 signals:
+    // TSV/CSV 以已处理字节数/总字节数报告，JSON 以条目数报告；最多每 PROGRESS_INTERVAL_MS 一次
     void parseProgress(int current, int total);
     void parseError(const QString &error, int line);
 
 private:
+    static constexpr int PROGRESS_INTERVAL_MS = 100;
+    static constexpr int MAX_FIELDS = 16;   // 超出的列忽略
+    static constexpr qsizetype PARALLEL_MIN_BYTES = 512 * 1024;  // 小于此大小顺序解析
+    static constexpr qsizetype MIN_CHUNK_BYTES = 128 * 1024;
+    static constexpr int CHUNKS_PER_THREAD = 4;                  // 多切几块以平衡各线程负载
+    
+    // TSV/CSV 的一个解析块（以整行为边界），行号都是块内行号（从 1 开始）
+    struct TsvCsvChunk
+    {
+        QByteArrayView content;
+        int lineCount = 0;
+        int headerLine = 0;         // 块内第一个像标题的行，0 表示没有；是否跳过在合并时决定
+        QList<SensorItem> items;
+        QVector<int> itemLines;     // 与 items 一一对应
+        QVector<int> failedLines;
+    };
+    
     // 格式检测
     ConfigFormat detectFormat(const QString &filePath) const;
     
-    // TSV/CSV 解析
-    QList<SensorItem> parseTsvCsv(const QString &content, QChar separator);
-    bool parseTsvCsvRow(const QStringList &fields, SensorItem &item);
+    // TSV/CSV 解析（UTF-8 内容，字段为指向原内容的视图）
+    QList<SensorItem> parseTsvCsv(QByteArrayView content, char separator);
+    QVector<TsvCsvChunk> splitTsvCsv(QByteArrayView content, int chunkCount) const;
+    // 可在工作线程中调用：除 reportDirectly 为 true 时的进度通知外不访问成员
+    void parseTsvCsvChunk(TsvCsvChunk &chunk, char separator, std::atomic<qint64> &processed,
+                          qint64 total, bool reportDirectly);
+    static bool parseTsvCsvRow(const QByteArrayView *fields, int fieldCount, SensorItem &item);
+    
+    // 限频的进度通知
+    void reportProgress(qint64 current, qint64 total, bool force = false);
     
     // JSON 解析
     QList<SensorItem> parseJson(const QString &content);
@@ -106,6 +147,8 @@ private:
     
     QString m_lastError;
     int m_errorLine;
+    int m_parseThreads;
+    QElapsedTimer m_progressTimer;
 };
 
 #endif // SENSORCONFIGPARSER_H
@@ -5,12 +5,31 @@
 
 #include "SensorItem.h"
 
+namespace {
+
+// 解析限值，为空或无法解析时返回 fallback（±无穷，即不限制）
+double parseLimit(const QString &text, double fallback)
+{
+    bool ok = false;
+    const double value = text.trimmed().toDouble(&ok);
+    return ok ? value : fallback;
+}
+
+} // namespace
+
 // ==================== 构造函数 ====================
 
 SensorItem::SensorItem()
     : m_address(0)
     , m_pointType(SensorPointType::HoldingRegister)
     , m_valueType(ModbusDataValueType::UINT16)
+    , m_byteOrder(WordOrder::ABCD)
+    , m_minLimit(-std::numeric_limits<double>::infinity())
+    , m_maxLimit(std::numeric_limits<double>::infinity())
+    , m_scale(1.0)
+    , m_inverseScale(1.0)
+    , m_offset(0.0)
+    , m_clamp(false)
     , m_readOnly(false)
     , m_registerCount(1)
 {
@@ -22,7 +41,14 @@ SensorItem::SensorItem(quint16 addr, const QString &name, SensorPointType pointT
     , m_name(name)
     , m_pointType(pointType)
     , m_valueType(valueType)
+    , m_byteOrder(WordOrder::ABCD)
     , m_initialValue(initVal)
+    , m_minLimit(-std::numeric_limits<double>::infinity())
+    , m_maxLimit(std::numeric_limits<double>::infinity())
+    , m_scale(1.0)
+    , m_inverseScale(1.0)
+    , m_offset(0.0)
+    , m_clamp(false)
     , m_readOnly(isReadOnlyType(pointType))
     , m_registerCount(ModbusValueConverter::registerCount(valueType))
 {
@@ -80,11 +106,39 @@ void SensorItem::setValueType(ModbusDataValueType type)
     m_registerCount = ModbusValueConverter::registerCount(type);
 }
 
+void SensorItem::setMinValue(const QString &min)
+{
+    m_minValue = min;
+    m_minLimit = parseLimit(min, -std::numeric_limits<double>::infinity());
+}
+
+void SensorItem::setMaxValue(const QString &max)
+{
+    m_maxValue = max;
+    m_maxLimit = parseLimit(max, std::numeric_limits<double>::infinity());
+}
+
+void SensorItem::setScale(double scale)
+{
+    // 比例系数为 0 或非有限值时无法反算原始值，按 1 处理
+    m_scale = (scale != 0.0 && qIsFinite(scale)) ? scale : 1.0;
+    m_inverseScale = 1.0 / m_scale;
+}
+
 // ==================== 辅助方法 ====================
 
 bool SensorItem::isValid() const
 {
-    return !m_name.isEmpty();
+    return !m_name.isEmpty() && fitsAddressSpace();
+}
+
+bool SensorItem::fitsAddressSpace() const
+{
+    // 线圈和离散输入只占一个地址
+    if (m_pointType == SensorPointType::Coil || m_pointType == SensorPointType::DiscreteInput) {
+        return true;
+    }
+    return int(m_address) + ModbusValueConverter::registerCount(m_valueType) <= 0x10000;
 }
 
 QPair<quint16, quint16> SensorItem::addressRange() const
@@ -94,7 +148,19 @@ QPair<quint16, quint16> SensorItem::addressRange() const
 
 bool SensorItem::toRegisters(QVector<quint16> &registers) const
 {
-    return ModbusValueConverter::stringToRegisters(m_initialValue, m_valueType, registers);
+    if (!hasTransform() || m_valueType == ModbusDataValueType::BOOL
+            || m_pointType == SensorPointType::Coil || m_pointType == SensorPointType::DiscreteInput) {
+        return ModbusValueConverter::stringToRegisters(m_initialValue, m_valueType, registers, m_byteOrder);
+    }
+
+    bool ok = false;
+    const double engineering = m_initialValue.trimmed().toDouble(&ok);
+    if (!ok) {
+        registers.clear();
+        return false;
+    }
+    ModbusValueConverter::doubleToRegisters(toRaw(engineering), m_valueType, registers, m_byteOrder);
+    return true;
 }
 
 QVariantMap SensorItem::toVariantMap() const
@@ -109,12 +175,16 @@ QVariantMap SensorItem::toVariantMap() const
     map["valueType"] = valueTypeString();
     map["valueTypeEnum"] = static_cast<int>(m_valueType);
     map["dataType"] = static_cast<int>(m_valueType);  // 兼容旧版
+    map["byteOrder"] = byteOrderString();
     map["initialValue"] = m_initialValue;
     map["description"] = m_description;
     map["note"] = m_description;  // 兼容旧版
     map["unit"] = m_unit;
     map["minValue"] = m_minValue;
     map["maxValue"] = m_maxValue;
+    map["scale"] = m_scale;
+    map["offset"] = m_offset;
+    map["clamp"] = m_clamp;
     map["readOnly"] = m_readOnly;
     map["registerCount"] = m_registerCount;
     return map;
@@ -141,11 +211,16 @@ SensorItem SensorItem::fromVariantMap(const QVariantMap &map)
         item.m_valueType = ModbusValueConverter::parseTypeString(map.value("valueType").toString());
     }
     
+    item.m_byteOrder = ModbusValueConverter::parseWordOrder(map.value("byteOrder").toString());
+    
     item.m_initialValue = map.value("initialValue").toString();
     item.m_description = map.value("description").toString();
     item.m_unit = map.value("unit").toString();
-    item.m_minValue = map.value("minValue").toString();
-    item.m_maxValue = map.value("maxValue").toString();
+    item.setMinValue(map.value("minValue").toString());
+    item.setMaxValue(map.value("maxValue").toString());
+    item.setScale(map.value("scale", 1.0).toDouble());
+    item.setOffset(map.value("offset", 0.0).toDouble());
+    item.setClamped(map.value("clamp", false).toBool());
     item.m_readOnly = map.value("readOnly", false).toBool();
     item.m_registerCount = ModbusValueConverter::registerCount(item.m_valueType);
     
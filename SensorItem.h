@@ -11,6 +11,7 @@
 #include <QString>
 #include <QVariant>
 #include <QtGlobal>
+#include <limits>
 #include "ModbusValueConverter.h"
 
 /**
@@ -80,6 +81,10 @@ public:
     void setValueType(ModbusDataValueType type);
     QString valueTypeString() const { return ModbusValueConverter::typeToString(m_valueType); }
     
+    WordOrder byteOrder() const { return m_byteOrder; }
+    void setByteOrder(WordOrder order) { m_byteOrder = order; }
+    QString byteOrderString() const { return ModbusValueConverter::wordOrderToString(m_byteOrder); }
+    
     QString initialValue() const { return m_initialValue; }
     void setInitialValue(const QString &value) { m_initialValue = value; }
     
@@ -90,10 +95,41 @@ public:
     void setUnit(const QString &unit) { m_unit = unit; }
     
     QString minValue() const { return m_minValue; }
-    void setMinValue(const QString &min) { m_minValue = min; }
+    void setMinValue(const QString &min);
     
     QString maxValue() const { return m_maxValue; }
-    void setMaxValue(const QString &max) { m_maxValue = max; }
+    void setMaxValue(const QString &max);
+    
+    // 工程量换算：工程值 = 原始值 × scale + offset，启用 clamp 时限制在 [最小值, 最大值]
+    double scale() const { return m_scale; }
+    void setScale(double scale);
+    
+    double offset() const { return m_offset; }
+    void setOffset(double offset) { m_offset = offset; }
+    
+    bool isClamped() const { return m_clamp; }
+    void setClamped(bool clamp) { m_clamp = clamp; }
+    
+    // 最小值/最大值在设置时解析一次，为空或无法解析时不限制
+    double minLimit() const { return m_minLimit; }
+    double maxLimit() const { return m_maxLimit; }
+    
+    // 是否需要换算（默认 scale=1、offset=0、不限幅时为原始值）
+    bool hasTransform() const { return m_scale != 1.0 || m_offset != 0.0 || m_clamp; }
+    
+    double toEngineering(double raw) const
+    {
+        const double value = raw * m_scale + m_offset;
+        return m_clamp ? qBound(m_minLimit, value, m_maxLimit) : value;
+    }
+    
+    double toRaw(double engineering) const
+    {
+        if (m_clamp) {
+            engineering = qBound(m_minLimit, engineering, m_maxLimit);
+        }
+        return (engineering - m_offset) * m_inverseScale;
+    }
     
     bool isReadOnly() const { return m_readOnly; }
     void setReadOnly(bool readOnly) { m_readOnly = readOnly; }
@@ -104,11 +140,20 @@ public:
     // ==================== 辅助方法 ====================
     
     /**
-     * @brief 检查配置是否有效
+     * @brief 检查配置是否有效（名称非空且占用的地址不越过 0xFFFF）
      * @return 是否有效
      */
     bool isValid() const;
     
+    /**
+     * @brief 点位占用的地址是否都在 16 位地址空间内
+     *
+     * 多寄存器点位不回绕到地址 0：address + registerCount 超过 0x10000 的点位无效，
+     * 批量解码和单点读取都不读取这类点位
+     * @return 是否在地址空间内
+     */
+    bool fitsAddressSpace() const;
+    
     /**
      * @brief 获取此点位占用的地址范围 [startAddr, endAddr]
      * @return QPair<起始地址, 结束地址>
@@ -116,7 +161,9 @@ public:
     QPair<quint16, quint16> addressRange() const;
     
     /**
-     * @brief 将初始值转换为寄存器数组
+     * @brief 将初始值按本点位的字节序转换为寄存器数组
+     *
+     * 有工程量换算时初始值按工程值解释，先换算回原始值再编码
      * @param registers 输出寄存器数组
      * @return 转换是否成功
      */
@@ -140,11 +187,18 @@ private:
     QString m_name;                     // 点位名称
     SensorPointType m_pointType;        // 点类型
     ModbusDataValueType m_valueType;    // 值类型
+    WordOrder m_byteOrder;              // 多寄存器值的字节序
     QString m_initialValue;             // 初始值
     QString m_description;              // 描述
     QString m_unit;                     // 单位
     QString m_minValue;                 // 最小值
     QString m_maxValue;                 // 最大值
+    double m_minLimit;                  // 最小值（数值，预先解析）
+    double m_maxLimit;                  // 最大值（数值，预先解析）
+    double m_scale;                     // 比例系数
+    double m_inverseScale;              // 1 / m_scale，写入时使用
+    double m_offset;                    // 偏移量
+    bool m_clamp;                       // 是否限幅到 [最小值, 最大值]
     bool m_readOnly;                    // 只读标志
     int m_registerCount;                // 占用寄存器数量
 };
@@ -26,6 +26,7 @@ bool SensorModelManager::importFromFile(const QString &filePath)
     m_sensors.clear();
     
     m_sensors = m_parser.importFromFile(filePath);
+    m_decoderDirty = true;
     
     if (m_sensors.isEmpty()) {
         m_lastError = m_parser.lastError();
@@ -105,6 +106,11 @@ bool SensorModelManager::applySensorToDataStore(const SensorItem &item, ModbusDa
 {
     QVector<quint16> registers;
     
+    if (!item.fitsAddressSpace()) {
+        qDebug() << "[SensorModel] 地址越界 - 地址:" << item.address() << "名称:" << item.name();
+        return false;
+    }
+    
     if (!item.toRegisters(registers)) {
         qDebug() << "[SensorModel] 转换失败 - 地址:" << item.address() 
                  << "名称:" << item.name() << "值:" << item.initialValue();
@@ -148,6 +154,64 @@ bool SensorModelManager::applySensorToDataStore(const SensorItem &item, ModbusDa
     return false;
 }
 
+// ==================== 当前值 ====================
+
+ModbusDataStore *SensorModelManager::dataStoreOf(QObject *serverObj) const
+{
+    ModbusServer *server = qobject_cast<ModbusServer*>(serverObj);
+    return server ? server->dataStore() : nullptr;
+}
+
+QStringList SensorModelManager::readCurrentValues(QObject *serverObj)
+{
+    ModbusDataStore *dataStore = dataStoreOf(serverObj);
+    if (!dataStore) {
+        return {};
+    }
+    
+    if (m_decoderDirty) {
+        m_decoder.setPoints(m_sensors);
+        m_decoderDirty = false;
+    }
+    m_image.capture(dataStore);
+    m_decoder.decode(m_image);
+    return m_decoder.displayValues();
+}
+
+QString SensorModelManager::readCurrentValue(QObject *serverObj, int index) const
+{
+    ModbusDataStore *dataStore = dataStoreOf(serverObj);
+    if (!dataStore || index < 0 || index >= m_sensors.count()) {
+        return QString();
+    }
+    
+    const SensorItem &item = m_sensors.at(index);
+    if (!item.fitsAddressSpace()) {
+        return QString();  // 与批量解码一致：越过 0xFFFF 的点位不读取
+    }
+    quint16 registers[4] = { 0, 0, 0, 0 };
+    switch (item.pointType()) {
+    case SensorPointType::Coil:
+        registers[0] = dataStore->readCoil(item.address());
+        break;
+    case SensorPointType::DiscreteInput:
+        registers[0] = dataStore->readDiscreteInput(item.address());
+        break;
+    case SensorPointType::HoldingRegister:
+    case SensorPointType::InputRegister: {
+        const bool holding = item.pointType() == SensorPointType::HoldingRegister;
+        const int count = ModbusValueConverter::registerCount(item.valueType());
+        for (int i = 0; i < count; ++i) {
+            const quint16 address = quint16(item.address() + i);
+            registers[i] = holding ? dataStore->readHoldingRegister(address)
+                                   : dataStore->readInputRegister(address);
+        }
+        break;
+    }
+    }
+    return PointBatchDecoder::decodeDisplayValue(item, registers);
+}
+
 // ==================== 传感器管理 ====================
 
 QVariantList SensorModelManager::getSensorList() const
@@ -172,12 +236,14 @@ void SensorModelManager::addSensor(const QString &name, const QString &type,
     item.setUnit(unit);
     
     m_sensors.append(item);
+    m_decoderDirty = true;
     emit sensorCountChanged(m_sensors.count());
 }
 
 void SensorModelManager::clearSensors()
 {
     m_sensors.clear();
+    m_decoderDirty = true;
     emit sensorCountChanged(0);
 }
 
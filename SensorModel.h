@@ -15,6 +15,7 @@
 #include <QList>
 #include "SensorItem.h"
 #include "SensorConfigParser.h"
+#include "PointBatchDecoder.h"
 
 // 前向声明:  避免不必要的头文件包、 加快编译速度、打破循环依赖、降低模块耦合度
 class ModbusServer;
@@ -64,6 +65,22 @@ public:
      */
     Q_INVOKABLE bool applyToServer(QObject *modbusServer);
     
+    // ==================== 当前值 ====================
+    
+    /**
+     * @brief 一次快照、一遍解码得到全部点位的当前值
+     * @param modbusServer Modbus服务器对象
+     * @return 与 getSensorList() 顺序一致的显示值
+     */
+    Q_INVOKABLE QStringList readCurrentValues(QObject *modbusServer);
+    
+    /**
+     * @brief 读取单个点位的当前值（寄存器变化时刷新一行）
+     * @param modbusServer Modbus服务器对象
+     * @param index 点位在列表中的序号
+     */
+    Q_INVOKABLE QString readCurrentValue(QObject *modbusServer, int index) const;
+    
     // ==================== 传感器管理 ====================
     
     /**
@@ -113,8 +130,13 @@ private:
     
     // 检查地址冲突
     void checkAddressConflicts() const;
+    
+    ModbusDataStore *dataStoreOf(QObject *serverObj) const;
 
     QList<SensorItem> m_sensors;
+    PointBatchDecoder m_decoder;
+    bool m_decoderDirty = true;     // 点表变化后需重新编译解码器
+    RegisterImage m_image;
     SensorConfigParser m_parser;
     QString m_lastError;
 };
@@ -1,6 +1,7 @@
 #include <QGuiApplication>
 #include <QQmlApplicationEngine>
 #include <QQmlContext>
+#include <QStandardPaths>
 #include <QDebug>
 #include "ModbusServer.h"
 #include "SensorModel.h"
@@ -27,6 +28,15 @@ int main(int argc, char *argv[])
     engine.rootContext()->setContextProperty(QStringLiteral("sensorManager"), &sensorManager);
     qDebug() << "对象已暴露给 QML";
 
+    // 文件记录保存在应用数据目录，重启后保留；须在创建默认文件之前加载。
+    // --memory-files：不落盘，文件只保存在内存中并按页压缩
+    if (app.arguments().contains(QStringLiteral("--memory-files"))) {
+        modbusServer.setFileCompression(true);
+    } else {
+        modbusServer.setFileStorageDirectory(
+            QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + QStringLiteral("/files"));
+    }
+
     // 初始化服务器数据
     modbusServer.initializeData();
     qDebug() << "服务器数据已初始化";